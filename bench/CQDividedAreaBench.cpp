@@ -0,0 +1,171 @@
+#include <CQDividedAreaLayout.h>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cstdlib>
+
+// Time CQDividedAreaLayout solves for increasing pane counts (no display needed)
+
+namespace {
+
+void
+initPanes(CQDividedAreaLayout &layout, int n)
+{
+  std::mt19937 gen(n);
+
+  std::uniform_int_distribution<int> prefDist(0, 400);
+  std::uniform_int_distribution<int> minDist (32, 96);
+  std::uniform_int_distribution<int> colDist (0, 3);
+
+  layout.clear();
+
+  for (int i = 0; i < n; ++i) {
+    CQDividedAreaLayout::Pane pane;
+
+    pane.titleHeight = 18;
+    pane.prefHeight  = prefDist(gen);
+    pane.minHeight   = minDist(gen);
+    pane.collapsed   = (colDist(gen) == 0);
+
+    layout.addPane(pane);
+  }
+}
+
+// check panes don't overlap, are at least min height and fit in rect
+bool
+checkLayout(const CQDividedAreaLayout &layout, const CQDividedAreaLayout::Rect &rect)
+{
+  int y = rect.y;
+
+  for (int i = 0; i < layout.numPanes(); ++i) {
+    const auto &pane = layout.pane(i);
+
+    if (pane.rect.y < y)
+      return false;
+
+    if (pane.isExpanded() && pane.contentsHeight() < pane.minHeight)
+      return false;
+
+    y = pane.rect.bottom();
+  }
+
+  return (y <= rect.bottom() || layout.numPanes() == 0);
+}
+
+// check incremental layout matches full layout
+bool
+sameLayout(const CQDividedAreaLayout &layout1, const CQDividedAreaLayout &layout2)
+{
+  if (layout1.numPanes() != layout2.numPanes())
+    return false;
+
+  for (int i = 0; i < layout1.numPanes(); ++i) {
+    const auto &pane1 = layout1.pane(i);
+    const auto &pane2 = layout2.pane(i);
+
+    if (pane1.rect != pane2.rect || pane1.splitter != pane2.splitter)
+      return false;
+
+    if (pane1.splitter && pane1.splitterRect != pane2.splitterRect)
+      return false;
+  }
+
+  return true;
+}
+
+// toggle collapsed state of pane and solve from it
+void
+togglePane(CQDividedAreaLayout &layout, const CQDividedAreaLayout::Rect &rect, int i)
+{
+  auto &pane = layout.pane(i);
+
+  pane.collapsed = ! pane.collapsed;
+
+  layout.solve(rect, i);
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+  int iterations = (argc > 1 ? std::atoi(argv[1]) : 1000);
+
+  if (iterations <= 0)
+    iterations = 1;
+
+  int rc = 0;
+
+  std::cout << std::setw(8) << "panes" << std::setw(14) << "us/solve" <<
+               std::setw(14) << "us/toggle" << "\n";
+
+  for (int n : { 10, 100, 1000, 10000 }) {
+    CQDividedAreaLayout layout;
+
+    initPanes(layout, n);
+
+    int niter = std::max(1, iterations*10/n);
+
+    // vary height so each solve does some work
+    auto t1 = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < niter; ++i) {
+      CQDividedAreaLayout::Rect rect(0, 0, 400, 20*n + (i % 97)*n);
+
+      layout.solve(rect);
+    }
+
+    auto t2 = std::chrono::steady_clock::now();
+
+    double us = std::chrono::duration<double, std::micro>(t2 - t1).count()/niter;
+
+    //---
+
+    CQDividedAreaLayout::Rect rect(0, 0, 400, 20*n);
+
+    layout.solve(rect);
+
+    if (! checkLayout(layout, rect)) {
+      std::cerr << "Bad layout for " << n << " panes\n";
+      rc = 1;
+    }
+
+    //---
+
+    // incremental solve from toggled bottom pane
+    auto t3 = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < niter; ++i)
+      togglePane(layout, rect, n - 1);
+
+    auto t4 = std::chrono::steady_clock::now();
+
+    double usToggle = std::chrono::duration<double, std::micro>(t4 - t3).count()/niter;
+
+    std::cout << std::setw(8) << n << std::setw(14) << std::fixed << std::setprecision(2) <<
+                 us << std::setw(14) << usToggle << "\n";
+
+    // incremental solve of random toggles must match full solve
+    std::mt19937 gen(n);
+
+    std::uniform_int_distribution<int> paneDist(0, n - 1);
+
+    for (int i = 0; i < 100; ++i) {
+      togglePane(layout, rect, paneDist(gen));
+
+      CQDividedAreaLayout layout1 = layout;
+
+      layout1.solve(rect, 0);
+
+      if (! sameLayout(layout, layout1)) {
+        std::cerr << "Bad incremental layout for " << n << " panes\n";
+        rc = 1;
+        break;
+      }
+    }
+  }
+
+  return rc;
+}
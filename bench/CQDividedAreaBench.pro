@@ -0,0 +1,24 @@
+TEMPLATE = app
+
+TARGET = CQDividedAreaBench
+
+DEPENDPATH += .
+
+INCLUDEPATH += ../include .
+
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG += console release
+CONFIG -= qt app_bundle
+
+# Input
+SOURCES += \
+CQDividedAreaBench.cpp \
+
+DESTDIR     = ../bin
+OBJECTS_DIR = ../obj
+LIB_DIR     = ../lib
+
+unix:LIBS += \
+-L$$LIB_DIR \
+-lCQDividedArea \
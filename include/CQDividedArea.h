@@ -1,21 +1,107 @@
 #ifndef CQDividedArea_H
 #define CQDividedArea_H
 
+#include <CQDividedAreaLayout.h>
 #include <CQIconButton.h>
 
 #include <QFrame>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QPixmap>
+#include <QImage>
+#include <QStaticText>
+#include <QCache>
+#include <QVariant>
+#include <QFutureWatcher>
 #include <QIcon>
-#include <map>
+#include <functional>
+#include <unordered_map>
+#include <vector>
 
 class CQDividedAreaWidget;
-class CQDividedAreaSplitter;
 class CQDividedAreaTitle;
 class CQDividedAreaTitleButton;
+class QRubberBand;
+class QTimer;
+class QPainter;
 
 class CQDividedArea : public QFrame {
   Q_OBJECT
 
-  Q_PROPERTY(bool singleArea READ isSingleArea WRITE setSingleArea)
+  Q_PROPERTY(bool singleArea        READ isSingleArea        WRITE setSingleArea)
+  Q_PROPERTY(bool deferLayout       READ isDeferLayout       WRITE setDeferLayout)
+  Q_PROPERTY(bool opaqueResize      READ isOpaqueResize      WRITE setOpaqueResize)
+  Q_PROPERTY(int  dragInterval      READ dragInterval        WRITE setDragInterval)
+  Q_PROPERTY(bool freezeOnDrag      READ isFreezeOnDrag      WRITE setFreezeOnDrag)
+  Q_PROPERTY(bool prewarm           READ isPrewarm           WRITE setPrewarm)
+  Q_PROPERTY(bool threadedTitles    READ isThreadedTitles    WRITE setThreadedTitles)
+  Q_PROPERTY(bool lightweightChrome READ isLightweightChrome WRITE setLightweightChrome)
+
+ public:
+  // begin/end update for scope
+  class UpdateGuard {
+   public:
+    UpdateGuard(CQDividedArea *area) :
+     area_(area) {
+      area_->beginUpdate();
+    }
+
+   ~UpdateGuard() {
+      area_->endUpdate();
+    }
+
+    UpdateGuard(const UpdateGuard &) = delete;
+    UpdateGuard &operator=(const UpdateGuard &) = delete;
+
+   private:
+    CQDividedArea *area_ { nullptr };
+  };
+
+ public:
+  // widget, title and icon for addWidgets
+  struct WidgetData {
+    QWidget* widget { nullptr };
+    QString  title;
+    QIcon    icon;
+
+    WidgetData() { }
+
+    WidgetData(QWidget *widget, const QString &title, const QIcon &icon=QIcon()) :
+     widget(widget), title(title), icon(icon) {
+    }
+  };
+
+ public:
+  // creates pane contents widget on demand
+  using WidgetFactory = std::function<QWidget *()>;
+
+  // creates pane contents widget from asynchronously loaded data
+  using WidgetBuilder = std::function<QWidget *(const QVariant &)>;
+
+ public:
+  // destroy contents of collapsed panes (created from factory) to save memory.
+  // Panes collapsed longer than idle time, or least recently expanded collapsed panes
+  // while total contents cost is over memory budget, are hibernated. save/restore
+  // hooks preserve contents state across destroy/recreate.
+  struct HibernatePolicy {
+    int                                              idleTime      { -1 };   // ms (-1 none)
+    qint64                                           memoryBudget  { -1 };   // (-1 none)
+    int                                              checkInterval { 1000 }; // ms
+    std::function<qint64(QWidget *)>                 cost;
+    std::function<QVariant(QWidget *)>               save;
+    std::function<void(QWidget *, const QVariant &)> restore;
+
+    HibernatePolicy() { }
+  };
+
+ public:
+  // pane size hint cache statistics
+  struct SizeCacheStats {
+    int hits   { 0 };
+    int misses { 0 };
+
+    SizeCacheStats() { }
+  };
 
  public:
   CQDividedArea(QWidget *parent=nullptr);
@@ -23,37 +109,292 @@ class CQDividedArea : public QFrame {
   bool isSingleArea() const { return singleArea_; }
   void setSingleArea(bool b) { singleArea_ = b; }
 
+  //! get/set defer layout (layout changes are coalesced and solved at next event loop)
+  bool isDeferLayout() const { return deferLayout_; }
+  void setDeferLayout(bool b);
+
+  //! get/set opaque resize (resize panes during splitter drag or only on release)
+  bool isOpaqueResize() const { return opaqueResize_; }
+  void setOpaqueResize(bool b) { opaqueResize_ = b; }
+
+  //! get/set min interval (ms) between splitter drag updates (0 for every mouse move)
+  int dragInterval() const { return dragInterval_; }
+  void setDragInterval(int i) { dragInterval_ = i; }
+
+  //! get/set freeze on drag (show snapshot of pane contents during splitter drag)
+  bool isFreezeOnDrag() const { return freezeOnDrag_; }
+  void setFreezeOnDrag(bool b) { freezeOnDrag_ = b; }
+
+  //! get/set lightweight chrome (titles painted by area instead of per pane widgets)
+  bool isLightweightChrome() const { return lightweightChrome_; }
+  void setLightweightChrome(bool b);
+
   CQDividedAreaWidget *addWidget(QWidget *w, const QString &title, const QIcon &icon=QIcon());
 
+  //! add pane whose contents is created by factory on first expand
+  //! (size estimate used for size hint until then)
+  CQDividedAreaWidget *addWidget(const WidgetFactory &factory, const QString &title,
+                                 const QIcon &icon=QIcon(), bool collapsed=true,
+                                 const QSize &sizeEstimate=QSize());
+
+  //! add multiple widgets (single relayout)
+  std::vector<CQDividedAreaWidget *> addWidgets(const std::vector<WidgetData> &widgetDatas);
+
+  //! remove widget (pane found in constant time but later panes are shifted and reindexed,
+  //! so use removeWidgets or clear to remove many)
   void removeWidget(QWidget *w);
 
+  //! add pane whose contents is built from future's result when ready
+  //! (placeholder of estimated size shown until then)
+  CQDividedAreaWidget *addAsyncWidget(const QFuture<QVariant> &future, const WidgetBuilder &builder,
+                                      const QString &title, const QIcon &icon=QIcon(),
+                                      const QSize &sizeEstimate=QSize());
+
+  //! remove pane
+  void removePane(CQDividedAreaWidget *widget);
+
+  //! remove multiple widgets (single relayout)
+  void removeWidgets(const std::vector<QWidget *> &widgets);
+
+  //! remove all widgets
+  void clear();
+
+  //! get area widget for contents widget or id
+  CQDividedAreaWidget *getWidget(QWidget *w) const;
+  CQDividedAreaWidget *getWidget(int id) const;
+
   QSize minimumSizeHint() const override;
 
   QSize sizeHint() const override;
 
+  //! get/set prewarm (create/polish collapsed pane contents in idle time)
+  //! (one pane per event loop pass, paused only while a mouse button is held)
+  bool isPrewarm() const { return prewarm_; }
+  void setPrewarm(bool b);
+
+  //! prewarm widget next (e.g. when hovered)
+  void prewarmWidget(CQDividedAreaWidget *widget);
+
+  //! get/set threaded titles (title bars rendered in thread pool)
+  //! (titles are rendered on GUI thread if platform doesn't support threaded font rendering)
+  bool isThreadedTitles() const { return threadedTitles_; }
+  void setThreadedTitles(bool b) { threadedTitles_ = b; }
+
+  //! is threaded title rendering supported by platform
+  bool isThreadedTitlesSupported() const;
+
+  //! get/set hibernate policy
+  const HibernatePolicy &hibernatePolicy() const { return hibernatePolicy_; }
+  void setHibernatePolicy(const HibernatePolicy &policy);
+
+  //! hibernate panes matching policy now (returns number hibernated)
+  int hibernatePanes();
+
+  //! get/reset pane size hint cache statistics
+  const SizeCacheStats &sizeCacheStats() const { return sizeCacheStats_; }
+  void resetSizeCacheStats() { sizeCacheStats_ = SizeCacheStats(); }
+
+  //! get/set max number of elided titles cached (shared by all panes)
+  int titleCacheSize() const { return titleCache_.maxCost(); }
+  void setTitleCacheSize(int n) { titleCache_.setMaxCost(n); }
+
+  //! begin/end batch update (layout and repaint deferred until outermost endUpdate)
+  void beginUpdate();
+  void endUpdate();
+
+  bool isUpdating() const { return updateDepth_ > 0; }
+
+  //! mark layout as needing update
+  void invalidateLayout();
+
+ public slots:
+  //! update layout now if invalid
+  void flushLayout();
+
  private:
   friend class CQDividedAreaWidget;
+  friend class CQDividedAreaTitle;
 
   void showEvent(QShowEvent *e) override;
 
   void resizeEvent(QResizeEvent *e) override;
 
-  void updateLayout(bool reset=true);
+  void changeEvent(QEvent *e) override;
+
+  bool event(QEvent *e) override;
+
+  void paintEvent(QPaintEvent *e) override;
+
+  void mousePressEvent  (QMouseEvent *e) override;
+  void mouseMoveEvent   (QMouseEvent *e) override;
+  void mouseReleaseEvent(QMouseEvent *e) override;
+
+  void leaveEvent(QEvent *e) override;
+
+  void contextMenuEvent(QContextMenuEvent *e) override;
+
+  void updateLayout();
+
+  void applyLayout(int start=0);
+
+  bool isPaneLayoutChanged(int i) const;
+
+  void invalidateLayoutFrom(int i);
+
+  void applyPaneLayout(int i);
+
+  void updateHandles(int start=0);
+
+  int handleAt(const QPoint &p) const;
+
+  QRect activeHandleRect() const;
+
+  void updateActiveHandle();
+
+  void updateHandleHover(const QPoint &p);
+
+  void startDrag(int id);
+
+  void moveDrag(int d);
+
+  void endDrag();
+
+  void cancelDrag();
+
+  void updateDrag();
+
+  void applyDrag();
+
+  void unfreezeDrag();
+
+  void updateRubberBand();
+
+  int numPanes() const { return int(panes_.size()); }
+
+  int paneIndex(int id) const;
+
+  CQDividedAreaWidget *createPane(const QString &title, const QIcon &icon);
+
+  void deletePane(int i);
+
+  void reindexPanes(int start);
+
+  void setWidgetCollapsed(CQDividedAreaWidget *widget, bool collapsed);
+
+  int paneAt(int y) const;
+
+  QRect paneWidgetRect(int i) const;
+
+  QFont chromeTitleFont() const;
+  int chromeTitleHeight() const;
+
+  QRect chromeTitleRect(int i) const;
+  QRect chromeButtonRect(const QRect &titleRect) const;
+
+  int chromeTitleAt(const QPoint &p) const;
+
+  void drawChromeTitle(QPainter *painter, int i, const QRect &rect);
+
+  void updateChromeTitle(int i);
+
+  void updateChromeHover(const QPoint &p);
+
+  QStaticText elidedTitle(const QString &title, const QFont &font, int width);
 
  private slots:
-  void splitterMoved(int d);
+  void dragTimerSlot();
 
-  void widgetCollapseStateChanged(bool collapsed);
+  void hibernateSlot();
+
+  void prewarmSlot();
 
  private:
-  typedef std::map<int, CQDividedAreaWidget *>   Widgets;
-  typedef std::map<int, CQDividedAreaSplitter *> Splitters;
+  // pane widgets in display order (layout constraints and geometry in layout_ at same index)
+  struct Pane {
+    CQDividedAreaWidget *widget { nullptr };
+    QRect                titleRect; // painted title rect (lightweight chrome)
+  };
+
+  // splitter handle below pane (geometry only, area does hit test and paint)
+  struct Handle {
+    int   pane { -1 };
+    QRect rect;
+
+    Handle() { }
+  };
+
+  // mouse state of pressed splitter handle
+  struct HandleMouse {
+    bool pressed { false };
+    int  lastY   { 0 };
+
+    HandleMouse() { }
+  };
+
+  using FrozenWidgets = std::vector<QPointer<CQDividedAreaWidget>>;
+
+  // elided and laid out title text for (title, font, width)
+  using TitleCache = QCache<QString, QStaticText>;
+
+  // active splitter drag
+  struct DragData {
+    int                            id      { 0 };     // id of pane above splitter
+    CQDividedAreaLayout::DragRange range;
+    int                            delta   { 0 };     // drag offset from drag start
+    int                            applied { 0 };     // clamped delta applied to layout
+    bool                           pending { false }; // delta not yet shown
+    QElapsedTimer                  time;
+    FrozenWidgets                  frozen;
+
+    DragData() { }
+  };
+
+  using Panes          = std::vector<Pane>;
+  using Handles        = std::vector<Handle>;
+  using ContentWidgets = std::unordered_map<QWidget *, CQDividedAreaWidget *>;
+  using IdWidgets      = std::unordered_map<int, CQDividedAreaWidget *>;
 
   static int widgetId;
 
-  Widgets   widgets_;
-  Splitters splitters_;
-  bool      singleArea_ { false };
+  Panes                  panes_;
+  ContentWidgets         contentWidgets_;
+  IdWidgets              idWidgets_;
+  bool                   singleArea_        { false };
+  bool                   deferLayout_       { false };
+  bool                   opaqueResize_      { true };
+  int                    dragInterval_      { 16 };
+  bool                   freezeOnDrag_      { false };
+  bool                   layoutDirty_       { false };
+  bool                   layoutPending_     { false };
+  int                    layoutStart_       { 0 };
+  bool                   layingOut_         { false };
+  bool                   panesChanged_      { false }; // panes added/removed since layout
+  int                    updateDepth_       { 0 };
+  bool                   updateEnabled_     { true };
+  CQDividedAreaLayout    layout_;
+  DragData               dragData_;
+  Handles                handles_;
+  bool                   handlesValid_      { false };
+  HandleMouse            handleMouse_;
+  int                    handleHover_       { 0 };
+  QRect                  activeHandleRect_;
+  QRubberBand*           rubberBand_        { nullptr };
+  QTimer*                dragTimer_         { nullptr };
+  HibernatePolicy        hibernatePolicy_;
+  QTimer*                hibernateTimer_    { nullptr };
+  QElapsedTimer          clock_;
+  bool                   prewarm_           { false };
+  QTimer*                prewarmTimer_      { nullptr };
+  int                    prewarmBump_       { 0 };
+  bool                   threadedTitles_    { false };
+  mutable int            threadedFonts_     { -1 };
+  mutable SizeCacheStats sizeCacheStats_;
+  TitleCache             titleCache_        { 1000 };
+  bool                   lightweightChrome_ { false };
+  mutable int            chromeTitleHeight_ { -1 };
+  int                    chromeHover_       { -1 };
+  bool                   chromeHoverButton_ { false };
+  int                    chromePressed_     { -1 };
 };
 
 //------
@@ -71,9 +412,39 @@ class CQDividedAreaWidget : public QWidget {
 
   int id() const { return id_; }
 
+  //! index in area
+  int index() const { return index_; }
+
   QWidget *widget() const { return w_; }
   void setWidget(QWidget *w);
 
+  //! set factory to create contents widget on demand and size estimate until created
+  void setFactory(const CQDividedArea::WidgetFactory &factory, const QSize &sizeEstimate);
+
+  //! create contents widget from factory if needed
+  bool ensureWidget();
+
+  //! destroy collapsed contents (recreated from factory on expand)
+  bool hibernate();
+
+  bool isHibernated() const { return hibernated_; }
+
+  //! set future (and builder) for contents loaded asynchronously
+  void setAsync(const QFuture<QVariant> &future, const CQDividedArea::WidgetBuilder &builder,
+                const QSize &sizeEstimate);
+
+  //! is waiting for async contents
+  bool isLoading() const;
+
+  //! get/set prewarm priority (higher prewarmed first)
+  int prewarmPriority() const { return prewarmPriority_; }
+  void setPrewarmPriority(int i) { prewarmPriority_ = i; }
+
+  //! get number of times expanded
+  int expandCount() const { return expandCount_; }
+
+  CQDividedArea *area() const { return area_; }
+
   const QString &title() const;
   void setTitle(const QString &title);
 
@@ -85,6 +456,10 @@ class CQDividedAreaWidget : public QWidget {
 
   void setTempCollapsed(bool collapsed);
 
+  //! get/set frozen (contents hidden and drawn from snapshot)
+  bool isFrozen() const { return frozen_; }
+  void setFrozen(bool frozen);
+
   int titleHeight() const;
 
   int contentsHeight() const;
@@ -103,22 +478,78 @@ class CQDividedAreaWidget : public QWidget {
  signals:
   void collapseStateChanged(bool);
 
+ private slots:
+  void asyncFinishedSlot();
+
  private:
   friend class CQDividedArea;
 
   void collapse();
 
+  void updateChrome();
+
+  void updateLayout();
+
+  bool updateCollapsed(bool collapsed);
+
   void updateState();
 
+  void resetContentsHeight(int height);
+
+  bool needsPrewarm() const;
+
+  void prewarm();
+
+  QSize contentsSizeHint() const;
+  QSize contentsMinSize() const;
+
+  void invalidateSizeCache();
+
+  bool event(QEvent *e) override;
+
+  bool eventFilter(QObject *o, QEvent *e) override;
+
+  void resizeEvent(QResizeEvent *e) override;
+
+  void paintEvent(QPaintEvent *) override;
+
  private:
-  CQDividedArea*      area_          { nullptr };
-  int                 id_            { 0 };
-  QWidget*            w_             { nullptr };
-  bool                collapsed_     { false };
-  bool                tempCollapsed_ { false };
-  int                 height_        { -1 };
-  int                 adjustHeight_  { 0 };
-  CQDividedAreaTitle* titleWidget_   { nullptr };
+  // cached contents size hint and min size
+  struct SizeCache {
+    QSize sizeHint;
+    QSize minSize;
+    bool  sizeHintValid { false };
+    bool  minSizeValid  { false };
+
+    SizeCache() { }
+  };
+
+  CQDividedArea*               area_            { nullptr };
+  int                          id_              { 0 };
+  int                          index_           { -1 };
+  QWidget*                     w_               { nullptr };
+  bool                         collapsed_       { false };
+  bool                         tempCollapsed_   { false };
+  int                          height_          { -1 };
+  int                          adjustHeight_    { 0 };
+  QString                      title_;
+  QIcon                        icon_;
+  CQDividedAreaTitle*          titleWidget_     { nullptr };
+  mutable SizeCache            sizeCache_;
+  bool                         frozen_          { false };
+  QPixmap                      snapshot_;
+  CQDividedArea::WidgetFactory factory_;
+  QSize                        sizeEstimate_;
+  bool                         hibernated_      { false };
+  QVariant                     hibernateState_;
+  qint64                       collapseTime_    { -1 };
+  qint64                       expandTime_      { -1 };
+  int                          expandCount_     { 0 };
+  int                          prewarmPriority_ { 0 };
+  int                          prewarmBump_     { 0 };
+  bool                         prewarmed_       { false };
+  CQDividedArea::WidgetBuilder builder_;
+  QFutureWatcher<QVariant>*    watcher_         { nullptr };
 };
 
 //------
@@ -151,6 +582,8 @@ class CQDividedAreaTitle : public QWidget {
 
   void paintEvent(QPaintEvent *) override;
 
+  void enterEvent(QEvent *) override;
+
   void contextMenuEvent(QContextMenuEvent *) override;
 
   void updateLayout();
@@ -160,13 +593,61 @@ class CQDividedAreaTitle : public QWidget {
  private slots:
   void collapseSlot();
 
+  void renderFinishedSlot();
+
  private:
+  // state rendered title pixmap depends on
+  struct RenderKey {
+    QSize   size;
+    qreal   dpr        { 1.0 };
+    QString title;
+    qint64  iconKey    { 0 };
+    QSize   iconSize;
+    qint64  paletteKey { 0 };
+    QString fontKey;
+    bool    collapsed  { false };
+
+    RenderKey() { }
+
+    bool operator==(const RenderKey &rhs) const {
+      return size == rhs.size && dpr == rhs.dpr && title == rhs.title &&
+             iconKey == rhs.iconKey && iconSize == rhs.iconSize &&
+             paletteKey == rhs.paletteKey && fontKey == rhs.fontKey &&
+             collapsed == rhs.collapsed;
+    }
+  };
+
+  // title state captured for render (safe to use off GUI thread)
+  struct RenderData {
+    QSize       size;
+    qreal       dpr         { 1.0 };
+    QString     title;       // title to elide (threaded)
+    int         textWidth   { 0 };
+    QStaticText staticText;  // cached elided title (GUI thread only)
+    QFont       font;
+    QImage      icon;
+    QSize       iconSize;
+    QColor      bg;
+    QColor      fg;
+    QColor      line;
+    int         buttonWidth { 0 };
+
+    RenderData() { }
+  };
+
+  RenderData renderData(const RenderKey &key, bool threaded) const;
+
+  static QImage renderImage(const RenderData &data);
+
   CQDividedAreaWidget      *widget_ { nullptr };
   QString                   title_;
   QIcon                     icon_;
   QSize                     iconSize_ { 10, 10 };
-  QColor                    bg_;
   CQDividedAreaTitleButton *collapseButton_ { nullptr };
+  RenderKey                 renderKey_;
+  QPixmap                   pixmap_;
+  RenderKey                 pendingKey_;
+  QFutureWatcher<QImage>*   renderWatcher_ { nullptr };
 };
 
 //------
@@ -184,45 +665,4 @@ class CQDividedAreaTitleButton : public CQIconButton {
   CQDividedAreaTitle *title_ { nullptr };
 };
 
-//------
-
-class CQDividedAreaSplitter : public QWidget {
-  Q_OBJECT
-
- public:
-  CQDividedAreaSplitter(CQDividedArea *area, int id);
-
-  int id() const { return id_; }
-
-  int otherId() const { return otherId_; }
-  void setOtherId(int id) { otherId_ = id; }
-
- private:
-  void mousePressEvent  (QMouseEvent *e) override;
-  void mouseMoveEvent   (QMouseEvent *e) override;
-  void mouseReleaseEvent(QMouseEvent *e) override;
-
-  void enterEvent(QEvent *e) override;
-  void leaveEvent(QEvent *e) override;
-
-  void paintEvent(QPaintEvent *) override;
-
- signals:
-  void moved(int d);
-
- private:
-  struct MouseState {
-    bool   pressed { false };
-    QPoint pressPos;
-
-    MouseState() { }
-  };
-
-  CQDividedArea *area_ { nullptr };
-  int            id_ { 0 };
-  int            otherId_ { 0 };
-  MouseState     mouseState_;
-  bool           mouseOver_ { false };
-};
-
 #endif
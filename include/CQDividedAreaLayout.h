@@ -0,0 +1,150 @@
+#ifndef CQDividedAreaLayout_H
+#define CQDividedAreaLayout_H
+
+#include <vector>
+#include <utility>
+
+// Headless layout model for CQDividedArea
+//
+// Panes are stacked vertically with a title bar and (if expanded) contents. A splitter
+// separates each pair of expanded panes. The last expanded pane fills the remaining space.
+//
+// Has no widget dependencies so it can be used (and timed) without a display.
+class CQDividedAreaLayout {
+ public:
+  struct Rect {
+    int x      { 0 };
+    int y      { 0 };
+    int width  { 0 };
+    int height { 0 };
+
+    Rect() { }
+
+    Rect(int x, int y, int width, int height) :
+     x(x), y(y), width(width), height(height) {
+    }
+
+    int bottom() const { return y + height; }
+
+    bool operator==(const Rect &rhs) const {
+      return x == rhs.x && y == rhs.y && width == rhs.width && height == rhs.height;
+    }
+
+    bool operator!=(const Rect &rhs) const { return ! (*this == rhs); }
+  };
+
+  struct Pane {
+    // constraints
+    int  titleHeight { 0 };     // title bar height
+    int  prefHeight  { 0 };     // preferred contents height
+    int  minHeight   { 0 };     // minimum contents height
+    bool collapsed   { false }; // collapsed by user
+
+    // solution
+    bool tempCollapsed { false }; // collapsed to fit
+    int  adjust        { 0 };     // amount preferred contents height shrunk to fit
+    Rect rect;                    // pane rect (title and contents)
+    bool splitter      { false }; // has splitter below
+    Rect splitterRect;            // splitter rect
+    int  next          { -1 };    // index of expanded pane below splitter
+
+    Pane() { }
+
+    bool isExpanded() const { return ! collapsed && ! tempCollapsed; }
+
+    int contentsHeight() const { return rect.height - titleHeight; }
+  };
+
+  using Panes = std::vector<Pane>;
+
+  // drag range of splitter below pane
+  struct DragRange {
+    int pane     { -1 }; // pane above splitter
+    int next     { -1 }; // expanded pane below splitter
+    int height1  { 0 };  // contents height of pane above at drag start
+    int height2  { 0 };  // contents height of pane below at drag start
+    int minDelta { 0 };  // min drag delta
+    int maxDelta { 0 };  // max drag delta
+
+    DragRange() { }
+
+    bool isValid() const { return pane >= 0 && next >= 0; }
+  };
+
+ public:
+  CQDividedAreaLayout();
+
+  //! get/set splitter height
+  int splitterHeight() const { return splitterHeight_; }
+  void setSplitterHeight(int h);
+
+  //! get/set number of panes
+  int numPanes() const { return int(panes_.size()); }
+  void setNumPanes(int n);
+
+  //! get pane
+  const Pane &pane(int i) const { return panes_[i]; }
+  Pane &pane(int i) { return panes_[i]; }
+
+  //! add pane
+  int addPane(const Pane &pane=Pane());
+
+  //! remove pane
+  void removePane(int i);
+
+  //! remove all panes
+  void clear();
+
+  //! solve layout for panes in rect (calc temp collapsed and adjust and place panes).
+  //! Only panes from start (lowest pane whose constraints changed since last solve) are
+  //! placed unless rect or the fit of panes above start changed. Added, removed and dragged
+  //! panes are included in start automatically
+  void solve(const Rect &rect, int start=0);
+
+  //! get first pane placed by last solve (panes above are unchanged)
+  int placeStart() const { return placeStart_; }
+
+  //! get drag range of splitter below pane i from current layout and min heights
+  DragRange splitterDragRange(int i) const;
+
+  //! drag splitter by d from drag start (clamped to range) and return clamped delta.
+  //! Only panes from range pane to next (inclusive) and the splitter are updated
+  int dragSplitter(const DragRange &range, int d);
+
+ private:
+  // sums of fit values of panes above pane
+  struct FitSums {
+    int title   { 0 }; // title heights
+    int min     { 0 }; // min heights of uncollapsed
+    int visible { 0 }; // number of uncollapsed
+    int delta   { 0 }; // preferred height above min of uncollapsed
+
+    FitSums() { }
+  };
+
+  using FitSumsArray = std::vector<FitSums>;
+  using OldFits      = std::vector<std::pair<bool, int>>;
+  using Deltas       = std::vector<int>;
+
+  int solveFit(int start);
+
+  static FitSums addFitSums(const FitSums &sums, const Pane &pane);
+
+  int firstChanged() const;
+
+  void place(int start);
+
+ private:
+  Panes        panes_;
+  Rect         rect_;
+  int          splitterHeight_ { 5 };
+  int          lastExpanded_   { -1 };    // last expanded pane of last solve
+  int          placeStart_     { 0 };
+  int          dirtyStart_     { 0 };     // first pane added/removed/dragged since last solve
+  bool         fitClean_       { false }; // last fit had no temp collapsed or shrunk panes
+  FitSumsArray prefix_;                   // fit sums of panes above each pane (last fit)
+  OldFits      old_;                      // scratch for previous fit
+  Deltas       deltas_;                   // scratch for shrink deltas
+};
+
+#endif
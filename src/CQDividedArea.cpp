@@ -1,13 +1,20 @@
 #include <CQDividedArea.h>
 #include <CQWidgetUtil.h>
 
-#include <QVBoxLayout>
 #include <QPainter>
 #include <QStylePainter>
 #include <QStyleOption>
 #include <QMouseEvent>
 #include <QMenu>
-
+#include <QRubberBand>
+#include <QTimer>
+#include <QGuiApplication>
+#include <QToolTip>
+#include <QFontDatabase>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <limits>
 #include <cassert>
 #include <iostream>
 
@@ -22,6 +29,25 @@ namespace Constants {
   int MIN_HEIGHT = 32;
 };
 
+namespace {
+
+// elide title to width (safe to use off GUI thread)
+QString
+elideTitle(const QString &title, const QFont &font, int width)
+{
+  QFontMetrics fm(font);
+
+  QString elided = fm.elidedText(title, Qt::ElideRight, width);
+
+  // if just an ellipsis keep first letter
+  if (elided.length() == 0 || elided.utf16()[0] == 8230)
+    elided = title[0] + "..";
+
+  return elided;
+}
+
+}
+
 int CQDividedArea::widgetId = 0;
 
 CQDividedArea::
@@ -29,37 +55,124 @@ CQDividedArea(QWidget *parent) :
  QFrame(parent)
 {
   setObjectName("dividedArea");
+
+  dragTimer_ = new QTimer(this);
+
+  dragTimer_->setSingleShot(true);
+
+  connect(dragTimer_, SIGNAL(timeout()), this, SLOT(dragTimerSlot()));
+
+  hibernateTimer_ = new QTimer(this);
+
+  connect(hibernateTimer_, SIGNAL(timeout()), this, SLOT(hibernateSlot()));
+
+  prewarmTimer_ = new QTimer(this);
+
+  prewarmTimer_->setInterval(0);
+
+  connect(prewarmTimer_, SIGNAL(timeout()), this, SLOT(prewarmSlot()));
+
+  clock_.start();
+
+  // hover highlight and cursor for splitter handles (and painted titles)
+  setMouseTracking(true);
 }
 
 CQDividedAreaWidget *
 CQDividedArea::
 addWidget(QWidget *w, const QString &title, const QIcon &icon)
+{
+  auto *widget = createPane(title, icon);
+
+  widget->setWidget(w);
+
+  invalidateLayoutFrom(widget->index());
+
+  return widget;
+}
+
+CQDividedAreaWidget *
+CQDividedArea::
+addWidget(const WidgetFactory &factory, const QString &title, const QIcon &icon,
+          bool collapsed, const QSize &sizeEstimate)
+{
+  auto *widget = createPane(title, icon);
+
+  // contents created by factory on first expand
+  widget->setFactory(factory, sizeEstimate);
+
+  widget->collapsed_ = collapsed;
+
+  widget->updateState();
+
+  invalidateLayoutFrom(widget->index());
+
+  if (isPrewarm())
+    prewarmTimer_->start();
+
+  return widget;
+}
+
+std::vector<CQDividedAreaWidget *>
+CQDividedArea::
+addWidgets(const std::vector<WidgetData> &widgetDatas)
+{
+  std::vector<CQDividedAreaWidget *> widgets;
+
+  if (widgetDatas.empty())
+    return widgets;
+
+  // single layout and repaint for all panes
+  UpdateGuard guard(this);
+
+  std::size_t n = panes_.size() + widgetDatas.size();
+
+  panes_         .reserve(n);
+  contentWidgets_.reserve(n);
+  idWidgets_     .reserve(n);
+
+  widgets.reserve(widgetDatas.size());
+
+  for (const auto &widgetData : widgetDatas) {
+    auto *widget = createPane(widgetData.title, widgetData.icon);
+
+    widget->setWidget(widgetData.widget);
+
+    widgets.push_back(widget);
+  }
+
+  invalidateLayoutFrom(widgets.front()->index());
+
+  return widgets;
+}
+
+CQDividedAreaWidget *
+CQDividedArea::
+createPane(const QString &title, const QIcon &icon)
 {
   int id = ++widgetId;
 
   auto *widget = new CQDividedAreaWidget(this, id);
 
-  widget->setWidget(w);
-  widget->setTitle (title);
-  widget->setIcon  (icon);
+  widget->setTitle(title);
+  widget->setIcon (icon);
 
-  connect(widget, SIGNAL(collapseStateChanged(bool)),
-          this, SLOT(widgetCollapseStateChanged(bool)));
+  Pane pane;
 
-  auto *splitter = new CQDividedAreaSplitter(this, id);
+  pane.widget = widget;
 
-  connect(splitter, SIGNAL(moved(int)), this, SLOT(splitterMoved(int)));
+  widget->index_ = numPanes();
 
-  widgets_  [id] = widget;
-  splitters_[id] = splitter;
+  panes_.push_back(pane);
 
-  widget  ->setObjectName(QString("widget_%1"  ).arg(id));
-  splitter->setObjectName(QString("splitter_%1").arg(id));
+  // layout indices stale until next layout
+  panesChanged_ = true;
 
-  widget->setVisible(true);
+  idWidgets_[id] = widget;
 
-  if (isVisible())
-    updateLayout();
+  widget->setObjectName(QString("widget_%1").arg(id));
+
+  widget->setVisible(true);
 
   return widget;
 }
@@ -68,377 +181,1719 @@ void
 CQDividedArea::
 removeWidget(QWidget *w)
 {
-  for (const auto &idWidget : widgets_) {
-    int                  id     = idWidget.first;
-    CQDividedAreaWidget *widget = idWidget.second;
+  CQDividedAreaWidget *widget = getWidget(w);
+  if (! widget) return;
 
-    if (widget->widget() != w) continue;
+  int i = widget->index();
 
-    auto ps = splitters_.find(id);
-    assert(ps != splitters_.end());
+  deletePane(i);
 
-    CQDividedAreaSplitter *splitter = (*ps).second;
+  // O(n) erase and reindex of later panes (contiguous pane table)
+  panes_.erase(panes_.begin() + i);
 
-    delete widget;
-    delete splitter;
+  // update indices of moved panes
+  reindexPanes(i);
 
-    widgets_  .erase(id);
-    splitters_.erase(ps);
+  invalidateLayoutFrom(i);
+}
 
-    if (isVisible())
-      updateLayout();
+void
+CQDividedArea::
+removePane(CQDividedAreaWidget *widget)
+{
+  int i = widget->index();
 
+  if (i < 0 || i >= numPanes() || panes_[i].widget != widget)
     return;
-  }
+
+  deletePane(i);
+
+  panes_.erase(panes_.begin() + i);
+
+  reindexPanes(i);
+
+  invalidateLayoutFrom(i);
 }
 
 void
 CQDividedArea::
-showEvent(QShowEvent *)
+removeWidgets(const std::vector<QWidget *> &widgets)
 {
-  updateLayout();
+  // delete panes and compact table in a single pass
+  int start = numPanes();
+
+  for (auto *w : widgets) {
+    CQDividedAreaWidget *widget = getWidget(w);
+    if (! widget) continue;
+
+    int i = widget->index();
+
+    deletePane(i);
+
+    panes_[i] = Pane();
+
+    start = std::min(start, i);
+  }
+
+  if (start >= numPanes())
+    return;
+
+  panes_.erase(std::remove_if(panes_.begin(), panes_.end(),
+                 [](const Pane &pane) { return ! pane.widget; }), panes_.end());
+
+  reindexPanes(start);
+
+  invalidateLayoutFrom(start);
 }
 
 void
 CQDividedArea::
-resizeEvent(QResizeEvent *)
+clear()
 {
-  updateLayout();
+  if (panes_.empty())
+    return;
+
+  int n = numPanes();
+
+  for (int i = 0; i < n; ++i)
+    deletePane(i);
+
+  panes_.clear();
+
+  invalidateLayout();
 }
 
 void
 CQDividedArea::
-updateLayout(bool reset)
+deletePane(int i)
 {
-  int l = contentsMargins().left  ();
-  int t = contentsMargins().top   ();
-  int r = contentsMargins().right  ();
-  int b = contentsMargins().bottom();
+  const Pane &pane = panes_[i];
 
-  //---
+  if (pane.widget->widget())
+    contentWidgets_.erase(pane.widget->widget());
 
-  // get visible widgets
-  std::vector<CQDividedAreaWidget *> visibleWidgets;
-  int                                numNonVisible = 0;
+  idWidgets_.erase(pane.widget->id());
 
-  for (const auto &idWidget : widgets_) {
-    CQDividedAreaWidget *widget = idWidget.second;
+  // layout indices stale until next layout
+  panesChanged_ = true;
 
-    // reset temp collapsed and adjist contents height if needed
-    if (reset) {
-      widget->setTempCollapsed(false);
+  // cancel drag of removed pane or whose pane indices are shifted by removal
+  if (dragData_.id && (dragData_.id == pane.widget->id() || i <= dragData_.range.next))
+    cancelDrag();
 
-      widget->setAdjustContentsHeight(0);
-    }
+  if (handleHover_ == pane.widget->id())
+    handleHover_ = 0;
 
-    if (! widget->isCollapsed()) {
-      visibleWidgets.push_back(widget);
+  // handles rebuilt by next layout
+  handles_.clear();
 
-      numNonVisible = 0;
-    }
-    else
-      ++numNonVisible;
-  }
+  handlesValid_ = false;
 
-  int numVisible = int(visibleWidgets.size());
+  update(activeHandleRect_);
 
-  CQDividedAreaWidget *lastWidget = (numVisible ? visibleWidgets.back() : nullptr);
+  activeHandleRect_ = QRect();
 
-  int lastSpace = (lastWidget ? numNonVisible*lastWidget->titleHeight() : 0);
+  if (isLightweightChrome())
+    update(pane.titleRect);
 
-  //---
+  chromeHover_   = -1;
+  chromePressed_ = -1;
 
-  int adjust   = 0;
-  int fixes    = 0;
-  int maxFixes = 2*(numVisible + 1);
+  delete pane.widget;
+}
 
-  while (fixes < maxFixes) {
-    int numMinHeight = 0;
+void
+CQDividedArea::
+reindexPanes(int start)
+{
+  int n = numPanes();
 
-    int lastExpandedId = 0;
+  for (int i = start; i < n; ++i)
+    panes_[i].widget->index_ = i;
+}
 
-    int x = l;
-    int y = t;
-    int w = width() - l - r;
-    int h = height() - t - b;
+CQDividedAreaWidget *
+CQDividedArea::
+getWidget(QWidget *w) const
+{
+  auto p = contentWidgets_.find(w);
 
-    for (const auto &idWidget : widgets_) {
-      int                  id     = idWidget.first;
-      CQDividedAreaWidget *widget = idWidget.second;
+  return (p != contentWidgets_.end() ? (*p).second : nullptr);
+}
 
-      bool expanded = ! widget->isCollapsed();
+CQDividedAreaWidget *
+CQDividedArea::
+getWidget(int id) const
+{
+  auto p = idWidgets_.find(id);
 
-      //---
+  return (p != idWidgets_.end() ? (*p).second : nullptr);
+}
 
-      CQDividedAreaSplitter *splitter = splitters_[id];
+int
+CQDividedArea::
+paneIndex(int id) const
+{
+  CQDividedAreaWidget *widget = getWidget(id);
 
-      if (reset)
-        splitter->setVisible(false);
+  return (widget ? widget->index() : -1);
+}
 
-      if (expanded && lastExpandedId > 0) {
-        CQDividedAreaSplitter *splitter = splitters_[lastExpandedId];
+void
+CQDividedArea::
+setHibernatePolicy(const HibernatePolicy &policy)
+{
+  hibernatePolicy_ = policy;
 
-        if (reset) {
-          splitter->setOtherId(id);
+  if (hibernatePolicy_.idleTime >= 0 || hibernatePolicy_.memoryBudget >= 0)
+    hibernateTimer_->start(hibernatePolicy_.checkInterval);
+  else
+    hibernateTimer_->stop();
+}
 
-          splitter->setVisible(true);
-        }
+void
+CQDividedArea::
+hibernateSlot()
+{
+  hibernatePanes();
+}
 
-        int sh = splitter->height();
+int
+CQDividedArea::
+hibernatePanes()
+{
+  const auto &policy = hibernatePolicy_;
 
-        splitter->move  (x, y);
-        splitter->resize(w, sh);
+  int num = 0;
 
-        y += sh;
-      }
+  // hibernate panes collapsed longer than idle time
+  if (policy.idleTime >= 0) {
+    qint64 t = clock_.elapsed();
 
-      //---
+    for (const auto &pane : panes_) {
+      CQDividedAreaWidget *widget = pane.widget;
 
-      int wh = widget->titleHeight();
+      if (widget->collapseTime_ < 0 || t - widget->collapseTime_ < policy.idleTime)
+        continue;
 
-      if (expanded) {
-        if (widget == lastWidget)
-          wh = h - y - lastSpace;
-        else
-          wh += widget->contentsHeight();
+      if (widget->hibernate())
+        ++num;
+    }
+  }
 
-        int minH = widget->minContentsHeight();
+  // hibernate least recently expanded panes until under memory budget
+  if (policy.memoryBudget >= 0 && policy.cost) {
+    qint64 total = 0;
 
-        if (wh < widget->titleHeight() + minH) {
-          wh = widget->titleHeight() + minH;
+    std::vector<CQDividedAreaWidget *> candidates;
 
-          ++numMinHeight;
-        }
-      }
+    for (const auto &pane : panes_) {
+      CQDividedAreaWidget *widget = pane.widget;
 
-      widget->move  (x, y);
-      widget->resize(w, wh);
+      if (! widget->widget())
+        continue;
 
-      if (expanded)
-        lastExpandedId = id;
+      total += policy.cost(widget->widget());
 
-      y += wh;
+      if (widget->isCollapsed())
+        candidates.push_back(widget);
     }
 
-    if (y <= h || ! reset)
-      break;
+    if (total > policy.memoryBudget) {
+      std::sort(candidates.begin(), candidates.end(),
+        [](CQDividedAreaWidget *w1, CQDividedAreaWidget *w2) {
+          return w1->expandTime_ < w2->expandTime_;
+        });
 
-    if      (numMinHeight < numVisible) {
-      adjust = y - h;
+      for (auto *widget : candidates) {
+        if (total <= policy.memoryBudget)
+          break;
 
-      int adjust1 = (numVisible > 1 ? adjust/(numVisible - 1) : 0);
+        qint64 cost = policy.cost(widget->widget());
 
-      for (const auto &idWidget : widgets_) {
-        CQDividedAreaWidget *widget = idWidget.second;
+        if (widget->hibernate()) {
+          total -= cost;
 
-        if (widget != lastWidget)
-          widget->setAdjustContentsHeight(widget->adjustContentsHeight() + adjust1);
+          ++num;
+        }
       }
     }
-    else if (lastWidget) {
-      lastWidget->setTempCollapsed(true);
+  }
 
-      visibleWidgets.pop_back();
+  return num;
+}
+
+void
+CQDividedArea::
+setPrewarm(bool b)
+{
+  prewarm_ = b;
 
-      --numVisible;
-      ++numNonVisible;
+  if (prewarm_)
+    prewarmTimer_->start();
+  else
+    prewarmTimer_->stop();
+}
 
-      lastWidget = (numVisible ? visibleWidgets.back() : nullptr);
+void
+CQDividedArea::
+prewarmWidget(CQDividedAreaWidget *widget)
+{
+  if (! isPrewarm() || ! widget->isCollapsed())
+    return;
 
-      lastSpace = (lastWidget ? numNonVisible*lastWidget->titleHeight() : 0);
-    }
-    else
-      break;
+  // move to front of prewarm queue
+  widget->prewarmBump_ = ++prewarmBump_;
 
-    ++fixes;
-  }
+  prewarmTimer_->start();
 }
 
 void
 CQDividedArea::
-splitterMoved(int d)
+prewarmSlot()
 {
-  CQDividedAreaSplitter *splitter = qobject_cast<CQDividedAreaSplitter *>(QObject::sender());
-  assert(splitter);
+  // wait while mouse button held (e.g. dragging), other input isn't detected
+  if (QGuiApplication::mouseButtons() != Qt::NoButton) {
+    prewarmTimer_->start(50);
+    return;
+  }
 
-  CQDividedAreaWidget *widget1 = widgets_[splitter->id()];      // top
-  CQDividedAreaWidget *widget2 = widgets_[splitter->otherId()]; // bottom
+  prewarmTimer_->setInterval(0);
 
-  int h1 = widget1->widget()->height() + d;
-  int h2 = widget2->widget()->height() - d;
+  // find best candidate: hovered (most recent first), then caller priority,
+  // then most often expanded
+  CQDividedAreaWidget *best = nullptr;
 
-  int minH1 = widget1->minContentsHeight();
-  int minH2 = widget2->minContentsHeight();
+  auto isBetter = [](const CQDividedAreaWidget *w1, const CQDividedAreaWidget *w2) {
+    if (w1->prewarmBump_      != w2->prewarmBump_     ) return w1->prewarmBump_      > w2->prewarmBump_;
+    if (w1->prewarmPriority() != w2->prewarmPriority()) return w1->prewarmPriority() > w2->prewarmPriority();
+    return w1->expandCount_ > w2->expandCount_;
+  };
 
-  if (h1 >= minH1 && h2 >= minH2) {
-    widget1->setContentsHeight(h1);
-    widget2->setContentsHeight(h2);
+  for (const auto &pane : panes_) {
+    CQDividedAreaWidget *widget = pane.widget;
 
-    widget1->resize(width(), widget1->titleHeight() + h1);
-    widget2->resize(width(), widget2->titleHeight() + h2);
+    if (! widget->needsPrewarm())
+      continue;
 
-    widget2->move(widget2->x(), widget2->y() + d);
+    if (! best || isBetter(widget, best))
+      best = widget;
+  }
 
-    splitter->move(splitter->x(), splitter->y() + d);
+  // nothing left to do
+  if (! best) {
+    prewarmTimer_->stop();
+    return;
   }
 
-  updateLayout(false);
+  // one pane per idle timeout
+  best->prewarm();
+}
+
+CQDividedAreaWidget *
+CQDividedArea::
+addAsyncWidget(const QFuture<QVariant> &future, const WidgetBuilder &builder,
+               const QString &title, const QIcon &icon, const QSize &sizeEstimate)
+{
+  auto *widget = createPane(title, icon);
+
+  // placeholder (size estimate) until data ready and contents built
+  widget->setAsync(future, builder, sizeEstimate);
+
+  invalidateLayoutFrom(widget->index());
+
+  return widget;
 }
 
 void
 CQDividedArea::
-widgetCollapseStateChanged(bool)
+setLightweightChrome(bool b)
 {
-  if (! isSingleArea())
+  if (b == lightweightChrome_)
     return;
 
-  CQDividedAreaWidget *widget = qobject_cast<CQDividedAreaWidget *>(sender());
-  if (! widget) return;
+  lightweightChrome_ = b;
+
+  chromeHover_   = -1;
+  chromePressed_ = -1;
 
-  for (const auto &idWidget : widgets_) {
-    CQDividedAreaWidget *widget = idWidget.second;
+  for (auto &pane : panes_) {
+    pane.widget->updateChrome();
 
-    disconnect(widget, SIGNAL(collapseStateChanged(bool)),
-               this, SLOT(widgetCollapseStateChanged(bool)));
+    pane.widget->setVisible(true);
+
+    pane.titleRect = QRect();
   }
 
-  if (widget->isCollapsed()) {
-    CQDividedAreaWidget *openWidget = nullptr;
+  invalidateLayout();
 
-    for (const auto &idWidget : widgets_) {
-      CQDividedAreaWidget *widget1 = idWidget.second;
-      if (widget1 == widget) continue;
+  update();
+}
+
+int
+CQDividedArea::
+paneAt(int y) const
+{
+  // last pane starting at or above y (pane rects are in increasing y)
+  int lo = 0;
+  int hi = layout_.numPanes();
 
-      if (! openWidget) {
-        widget1->setCollapsed(true);
+  while (lo < hi) {
+    int mid = (lo + hi)/2;
 
-        openWidget = widget1;
-      }
-      else
-        widget1->setCollapsed(false);
-    }
+    if (layout_.pane(mid).rect.y <= y)
+      lo = mid + 1;
+    else
+      hi = mid;
   }
-  else {
-    for (const auto &idWidget : widgets_) {
-      CQDividedAreaWidget *widget1 = idWidget.second;
-      if (widget1 == widget) continue;
 
-      widget1->setCollapsed(true);
-    }
-  }
+  return lo - 1;
+}
+
+QRect
+CQDividedArea::
+paneWidgetRect(int i) const
+{
+  const CQDividedAreaLayout::Pane &pane = layout_.pane(i);
 
-  for (const auto &idWidget : widgets_) {
-    CQDividedAreaWidget *widget = idWidget.second;
+  const auto &r = pane.rect;
 
-    connect(widget, SIGNAL(collapseStateChanged(bool)),
-            this, SLOT(widgetCollapseStateChanged(bool)));
-  }
+  // pane widget is just contents when area paints title
+  if (isLightweightChrome())
+    return QRect(r.x, r.y + pane.titleHeight, r.width, r.height - pane.titleHeight);
+
+  return QRect(r.x, r.y, r.width, r.height);
 }
 
-QSize
+QFont
 CQDividedArea::
-minimumSizeHint() const
+chromeTitleFont() const
 {
-  int l = contentsMargins().left  ();
-  int t = contentsMargins().top   ();
-  int r = contentsMargins().right  ();
-  int b = contentsMargins().bottom();
+  QFont f = font();
 
-  int w = 0;
-  int h = 0;
+  f.setBold(true);
 
-  for (const auto &idWidget : widgets_) {
-    const CQDividedAreaWidget *widget = idWidget.second;
+  return f;
+}
 
-    w = std::max(w, widget->minimumSizeHint().width());
+int
+CQDividedArea::
+chromeTitleHeight() const
+{
+  if (chromeTitleHeight_ < 0) {
+    QFontMetrics fm(chromeTitleFont());
 
-    h += widget->minimumSizeHint().height();
+    chromeTitleHeight_ = fm.height() + 2;
   }
 
-  return QSize(w + l + r, h + t + b);
+  return chromeTitleHeight_;
 }
 
-QSize
+QRect
 CQDividedArea::
-sizeHint() const
+chromeTitleRect(int i) const
 {
-  if (widgets_.empty())
-    return QFrame::minimumSizeHint();
+  const CQDividedAreaLayout::Pane &pane = layout_.pane(i);
 
-  int l = contentsMargins().left  ();
-  int t = contentsMargins().top   ();
-  int r = contentsMargins().right  ();
-  int b = contentsMargins().bottom();
+  return QRect(pane.rect.x, pane.rect.y, pane.rect.width, pane.titleHeight);
+}
 
-  int w = 0;
-  int h = 0;
+QRect
+CQDividedArea::
+chromeButtonRect(const QRect &titleRect) const
+{
+  int s = titleRect.height() - 2;
+
+  return QRect(titleRect.right() - s - 1, titleRect.top() + 1, s, s);
+}
+
+int
+CQDividedArea::
+chromeTitleAt(const QPoint &p) const
+{
+  if (! isLightweightChrome() || panesChanged_)
+    return -1;
+
+  int i = paneAt(p.y());
 
-  for (const auto &idWidget : widgets_) {
-    const CQDividedAreaWidget *widget = idWidget.second;
+  if (i < 0 || ! chromeTitleRect(i).contains(p))
+    return -1;
 
-    w = std::max(w, widget->sizeHint().width());
+  return i;
+}
+
+void
+CQDividedArea::
+drawChromeTitle(QPainter *painter, int i, const QRect &rect)
+{
+  CQDividedAreaWidget *widget = panes_[i].widget;
+
+  painter->fillRect(rect, QBrush(palette().window().color().darker(110)));
+
+  int x = rect.left() + 2;
+  int h = rect.height();
+
+  int iw = 0;
+
+  if (! widget->icon().isNull()) {
+    QSize is(10, 10);
+
+    iw = is.width() + 2;
+
+    painter->drawPixmap(x, rect.top() + (h - is.height())/2, widget->icon().pixmap(is));
 
-    h += widget->sizeHint().height();
+    x += iw;
   }
 
-  return QSize(w + l + r, h + t + b);
+  QRect buttonRect = chromeButtonRect(rect);
+
+  if (widget->title().length()) {
+    QFont font = chromeTitleFont();
+
+    QFontMetrics fm(font);
+
+    int tw = rect.width() - iw - buttonRect.width() - 6;
+
+    painter->setFont(font);
+    painter->setPen (palette().color(QPalette::WindowText));
+
+    painter->drawStaticText(x, rect.top() + (h - fm.height())/2,
+                            elidedTitle(widget->title(), font, tw));
+  }
+
+  // collapse button (raised when hovered)
+  QStyleOption opt;
+
+  opt.initFrom(this);
+
+  opt.rect  = buttonRect;
+  opt.state = QStyle::State_Enabled;
+
+  if (i == chromeHover_ && chromeHoverButton_) {
+    opt.state |= QStyle::State_MouseOver | QStyle::State_Raised | QStyle::State_AutoRaise;
+
+    if (i == chromePressed_)
+      opt.state |= QStyle::State_Sunken;
+
+    style()->drawPrimitive(QStyle::PE_PanelButtonTool, &opt, painter, this);
+  }
+
+  style()->drawPrimitive(widget->isCollapsed() ? QStyle::PE_IndicatorArrowUp :
+                         QStyle::PE_IndicatorArrowDown, &opt, painter, this);
+
+  painter->setPen(palette().window().color().darker(200));
+
+  painter->drawLine(rect.left(), rect.bottom(), rect.right(), rect.bottom());
+}
+
+void
+CQDividedArea::
+updateChromeTitle(int i)
+{
+  if (! isLightweightChrome() || i < 0 || i >= layout_.numPanes())
+    return;
+
+  update(chromeTitleRect(i));
+}
+
+void
+CQDividedArea::
+updateChromeHover(const QPoint &p)
+{
+  int  i      = chromeTitleAt(p);
+  bool button = (i >= 0 && chromeButtonRect(chromeTitleRect(i)).contains(p));
+
+  if (i == chromeHover_ && button == chromeHoverButton_)
+    return;
+
+  int oldHover = chromeHover_;
+
+  chromeHover_       = i;
+  chromeHoverButton_ = button;
+
+  updateChromeTitle(oldHover);
+  updateChromeTitle(i);
+
+  // likely to be expanded soon
+  if (i >= 0 && i != oldHover)
+    prewarmWidget(panes_[i].widget);
+}
+
+bool
+CQDividedArea::
+isThreadedTitlesSupported() const
+{
+  // text can only be drawn to an image off the GUI thread if platform supports it
+  if (threadedFonts_ < 0)
+    threadedFonts_ = (QFontDatabase::supportsThreadedFontRendering() ? 1 : 0);
+
+  return (threadedFonts_ == 1);
+}
+
+QStaticText
+CQDividedArea::
+elidedTitle(const QString &title, const QFont &font, int width)
+{
+  QString key = font.key() + '\n' + QString::number(width) + '\n' + title;
+
+  const QStaticText *cached = titleCache_.object(key);
+
+  if (cached)
+    return *cached;
+
+  QStaticText text(elideTitle(title, font, width));
+
+  text.setTextFormat(Qt::PlainText);
+  text.setPerformanceHint(QStaticText::AggressiveCaching);
+
+  text.prepare(QTransform(), font);
+
+  // least recently used evicted when full
+  titleCache_.insert(key, new QStaticText(text));
+
+  return text;
+}
+
+void
+CQDividedArea::
+setDeferLayout(bool b)
+{
+  deferLayout_ = b;
+
+  if (! deferLayout_)
+    flushLayout();
+}
+
+void
+CQDividedArea::
+showEvent(QShowEvent *)
+{
+  // full layout before first paint (includes any deferred changes)
+  layoutStart_ = 0;
+  layoutDirty_ = true;
+
+  flushLayout();
+}
+
+void
+CQDividedArea::
+resizeEvent(QResizeEvent *)
+{
+  invalidateLayout();
+}
+
+void
+CQDividedArea::
+changeEvent(QEvent *e)
+{
+  // title height depends on font
+  if (e->type() == QEvent::FontChange) {
+    chromeTitleHeight_ = -1;
+
+    invalidateLayout();
+  }
+
+  QFrame::changeEvent(e);
+}
+
+bool
+CQDividedArea::
+event(QEvent *e)
+{
+  // tooltip for painted collapse button
+  if (e->type() == QEvent::ToolTip && isLightweightChrome()) {
+    auto *he = static_cast<QHelpEvent *>(e);
+
+    int i = chromeTitleAt(he->pos());
+
+    if (i >= 0 && chromeButtonRect(chromeTitleRect(i)).contains(he->pos())) {
+      QToolTip::showText(he->globalPos(),
+                         panes_[i].widget->isCollapsed() ? "Expand" : "Collapse", this);
+      return true;
+    }
+  }
+
+  return QFrame::event(e);
+}
+
+void
+CQDividedArea::
+paintEvent(QPaintEvent *e)
+{
+  QFrame::paintEvent(e);
+
+  QPainter painter(this);
+
+  // panes added/removed so layout pending (handle drawn after it is applied)
+  bool layoutPending = panesChanged_;
+
+  // only hovered or pressed handle is drawn
+  QRect handleRect = (! layoutPending ? activeHandleRect() : QRect());
+
+  if (handleRect.intersects(e->rect())) {
+    QStyleOption opt;
+
+    opt.initFrom(this);
+
+    opt.rect  = handleRect;
+    opt.state = QStyle::State_MouseOver;
+
+    if (dragData_.id)
+      opt.state |= QStyle::State_Sunken;
+
+    style()->drawControl(QStyle::CE_Splitter, &opt, &painter, this);
+  }
+
+  if (! isLightweightChrome())
+    return;
+
+  // titles at last applied position (matches pane widgets even if layout pending).
+  // Only titles intersecting update rect (panes in increasing y once laid out)
+  const QRect &r = e->rect();
+
+  int n  = numPanes();
+  int i1 = (! layoutPending ? std::max(paneAt(r.top()), 0) : 0);
+
+  for (int i = i1; i < n; ++i) {
+    const QRect &titleRect = panes_[i].titleRect;
+
+    if (titleRect.isNull())
+      continue;
+
+    if (! layoutPending && titleRect.top() > r.bottom())
+      break;
+
+    if (titleRect.intersects(r))
+      drawChromeTitle(&painter, i, titleRect);
+  }
+}
+
+void
+CQDividedArea::
+mousePressEvent(QMouseEvent *e)
+{
+  if (e->button() == Qt::LeftButton) {
+    int h = handleAt(e->pos());
+
+    if (h >= 0) {
+      handleMouse_.pressed = true;
+      handleMouse_.lastY   = e->globalPos().y();
+
+      startDrag(panes_[handles_[h].pane].widget->id());
+
+      updateActiveHandle();
+
+      return;
+    }
+
+    int i = chromeTitleAt(e->pos());
+
+    if (i >= 0 && chromeButtonRect(chromeTitleRect(i)).contains(e->pos())) {
+      chromePressed_ = i;
+
+      updateChromeTitle(i);
+
+      return;
+    }
+  }
+
+  QFrame::mousePressEvent(e);
+}
+
+void
+CQDividedArea::
+mouseMoveEvent(QMouseEvent *e)
+{
+  // drag by change since last move (drag restarted if relayout)
+  if (handleMouse_.pressed) {
+    int y = e->globalPos().y();
+    int d = y - handleMouse_.lastY;
+
+    handleMouse_.lastY = y;
+
+    if (d)
+      moveDrag(d);
+
+    return;
+  }
+
+  updateHandleHover(e->pos());
+
+  updateChromeHover(e->pos());
+
+  QFrame::mouseMoveEvent(e);
+}
+
+void
+CQDividedArea::
+mouseReleaseEvent(QMouseEvent *e)
+{
+  if (handleMouse_.pressed) {
+    handleMouse_.pressed = false;
+
+    endDrag();
+
+    updateHandleHover(e->pos());
+
+    return;
+  }
+
+  if (chromePressed_ >= 0) {
+    int i = chromePressed_;
+
+    chromePressed_ = -1;
+
+    updateChromeTitle(i);
+
+    // click if released over pressed button
+    if (chromeTitleAt(e->pos()) == i &&
+        chromeButtonRect(chromeTitleRect(i)).contains(e->pos())) {
+      CQDividedAreaWidget *widget = panes_[i].widget;
+
+      widget->setCollapsed(! widget->isCollapsed());
+    }
+
+    return;
+  }
+
+  QFrame::mouseReleaseEvent(e);
+}
+
+void
+CQDividedArea::
+leaveEvent(QEvent *e)
+{
+  if (! handleMouse_.pressed)
+    updateHandleHover(QPoint(-1, -1));
+
+  updateChromeHover(QPoint(-1, -1));
+
+  QFrame::leaveEvent(e);
+}
+
+void
+CQDividedArea::
+contextMenuEvent(QContextMenuEvent *e)
+{
+  int i = chromeTitleAt(e->pos());
+
+  if (i < 0) {
+    QFrame::contextMenuEvent(e);
+    return;
+  }
+
+  QPointer<CQDividedAreaWidget> widget = panes_[i].widget;
+
+  QMenu menu;
+
+  QAction *collapseAction = menu.addAction(widget->isCollapsed() ? "Expand" : "Collapse");
+
+  if (menu.exec(e->globalPos()) == collapseAction && widget)
+    widget->setCollapsed(! widget->isCollapsed());
+}
+
+void
+CQDividedArea::
+beginUpdate()
+{
+  if (updateDepth_++ > 0)
+    return;
+
+  // suppress repaints until end of update
+  updateEnabled_ = updatesEnabled();
+
+  if (updateEnabled_)
+    setUpdatesEnabled(false);
+}
+
+void
+CQDividedArea::
+endUpdate()
+{
+  assert(updateDepth_ > 0);
+
+  if (--updateDepth_ > 0)
+    return;
+
+  // single layout for all changes (before repaint)
+  flushLayout();
+
+  if (updateEnabled_)
+    setUpdatesEnabled(true);
+}
+
+void
+CQDividedArea::
+invalidateLayout()
+{
+  invalidateLayoutFrom(0);
+}
+
+void
+CQDividedArea::
+invalidateLayoutFrom(int i)
+{
+  // lowest pane changed since last layout
+  layoutStart_ = std::min(layoutStart_, i);
+
+  layoutDirty_ = true;
+
+  // layout at end of update
+  if (isUpdating())
+    return;
+
+  // layout on show
+  if (! isVisible())
+    return;
+
+  // layout now unless changed by current layout (e.g. contents shown)
+  if (! isDeferLayout() && ! layingOut_) {
+    flushLayout();
+    return;
+  }
+
+  if (! layoutPending_) {
+    layoutPending_ = true;
+
+    QTimer::singleShot(0, this, SLOT(flushLayout()));
+  }
+}
+
+void
+CQDividedArea::
+flushLayout()
+{
+  layoutPending_ = false;
+
+  if (! layoutDirty_ || ! isVisible() || isUpdating())
+    return;
+
+  layoutDirty_ = false;
+
+  updateLayout();
+}
+
+void
+CQDividedArea::
+updateLayout()
+{
+  int l = contentsMargins().left  ();
+  int t = contentsMargins().top   ();
+  int r = contentsMargins().right ();
+  int b = contentsMargins().bottom();
+
+  //---
+
+  // update layout constraints of changed panes (query each widget once)
+  int n     = numPanes();
+  int start = std::min(layoutStart_, n);
+
+  layout_.setNumPanes(n);
+
+  panesChanged_ = false;
+
+  for (int i = start; i < n; ++i) {
+    CQDividedAreaWidget *widget = panes_[i].widget;
+
+    CQDividedAreaLayout::Pane &pane = layout_.pane(i);
+
+    pane.titleHeight = widget->titleHeight();
+    pane.collapsed   = widget->collapsed_;
+
+    if (! pane.collapsed) {
+      pane.prefHeight = widget->contentsHeight() + widget->adjustContentsHeight();
+      pane.minHeight  = widget->minContentsHeight();
+    }
+  }
+
+  //---
+
+  // calc temp collapsed and adjust and place widgets
+  layout_.solve(CQDividedAreaLayout::Rect(l, t, width() - l - r, height() - t - b), start);
+
+  // panes invalidated while applying are laid out next
+  layoutStart_ = std::numeric_limits<int>::max();
+
+  layingOut_ = true;
+
+  applyLayout(layout_.placeStart());
+
+  layingOut_ = false;
+
+  // restart active drag from new layout keeping drag offset not yet applied to layout
+  // (pending throttled delta, overdrag past range or whole rubber band offset)
+  if (dragData_.id) {
+    int  delta   = dragData_.delta - dragData_.applied;
+    bool pending = dragData_.pending;
+
+    startDrag(dragData_.id);
+
+    if (dragData_.range.isValid()) {
+      dragData_.delta = delta;
+
+      if (isOpaqueResize()) {
+        if (pending)
+          updateDrag();
+      }
+      else {
+        if (rubberBand_ && rubberBand_->isVisible())
+          updateRubberBand();
+      }
+    }
+  }
+}
+
+void
+CQDividedArea::
+applyLayout(int start)
+{
+  int n = numPanes();
+  assert(n == layout_.numPanes());
+
+  // apply panes whose solved geometry or state differs from widget (panes above start
+  // weren't placed so are unchanged)
+  for (int i = start; i < n; ++i) {
+    if (isPaneLayoutChanged(i))
+      applyPaneLayout(i);
+  }
+
+  updateHandles(start);
+}
+
+bool
+CQDividedArea::
+isPaneLayoutChanged(int i) const
+{
+  const CQDividedAreaLayout::Pane &pane = layout_.pane(i);
+
+  CQDividedAreaWidget *widget = panes_[i].widget;
+
+  if (widget->tempCollapsed_ != pane.tempCollapsed ||
+      widget->adjustContentsHeight() != pane.adjust)
+    return true;
+
+  if (widget->geometry() != paneWidgetRect(i))
+    return true;
+
+  if (isLightweightChrome()) {
+    if (widget->isHidden() == pane.isExpanded() || panes_[i].titleRect != chromeTitleRect(i))
+      return true;
+  }
+
+  return false;
+}
+
+void
+CQDividedArea::
+applyPaneLayout(int i)
+{
+  const CQDividedAreaLayout::Pane &pane = layout_.pane(i);
+
+  CQDividedAreaWidget *widget = panes_[i].widget;
+
+  if (widget->tempCollapsed_ != pane.tempCollapsed)
+    widget->setTempCollapsed(pane.tempCollapsed);
+
+  widget->setAdjustContentsHeight(pane.adjust);
+
+  // single move/resize event and only if changed (panes below a change usually just move)
+  QRect rect = paneWidgetRect(i);
+
+  if      (widget->size() == rect.size()) {
+    if (widget->pos() != rect.topLeft())
+      widget->move(rect.topLeft());
+  }
+  else
+    widget->setGeometry(rect);
+
+  if (isLightweightChrome()) {
+    // only contents are a widget so hide when collapsed
+    bool visible = pane.isExpanded();
+
+    if (widget->isHidden() == visible)
+      widget->setVisible(visible);
+
+    // repaint title at old and new position
+    QRect titleRect = chromeTitleRect(i);
+
+    if (titleRect != panes_[i].titleRect) {
+      update(panes_[i].titleRect);
+      update(titleRect);
+
+      panes_[i].titleRect = titleRect;
+    }
+  }
+}
+
+void
+CQDividedArea::
+updateHandles(int start)
+{
+  // handles of panes above start are unchanged
+  if (! handlesValid_)
+    start = 0;
+
+  auto ph = std::lower_bound(handles_.begin(), handles_.end(), start,
+              [](const Handle &handle, int i) { return handle.pane < i; });
+
+  // handles in increasing y for hit test
+  handles_.erase(ph, handles_.end());
+
+  int n = layout_.numPanes();
+
+  for (int i = start; i < n; ++i) {
+    const CQDividedAreaLayout::Pane &pane = layout_.pane(i);
+
+    if (! pane.splitter)
+      continue;
+
+    const auto &r = pane.splitterRect;
+
+    Handle handle;
+
+    handle.pane = i;
+    handle.rect = QRect(r.x, r.y, r.width, r.height);
+
+    handles_.push_back(handle);
+  }
+
+  handlesValid_ = true;
+
+  updateActiveHandle();
+}
+
+int
+CQDividedArea::
+handleAt(const QPoint &p) const
+{
+  // no handles until pending layout applied
+  if (panesChanged_)
+    return -1;
+
+  // binary search for last handle starting at or above y
+  auto ph = std::upper_bound(handles_.begin(), handles_.end(), p.y(),
+              [](int y, const Handle &handle) { return y < handle.rect.top(); });
+
+  if (ph == handles_.begin())
+    return -1;
+
+  --ph;
+
+  if (! (*ph).rect.contains(p))
+    return -1;
+
+  return int(ph - handles_.begin());
+}
+
+QRect
+CQDividedArea::
+activeHandleRect() const
+{
+  if (panesChanged_)
+    return QRect();
+
+  // pressed handle, otherwise hovered handle
+  int id = (dragData_.id ? dragData_.id : handleHover_);
+
+  int i = paneIndex(id);
+
+  if (i < 0 || i >= layout_.numPanes() || ! layout_.pane(i).splitter)
+    return QRect();
+
+  const auto &r = layout_.pane(i).splitterRect;
+
+  return QRect(r.x, r.y, r.width, r.height);
+}
+
+void
+CQDividedArea::
+updateActiveHandle()
+{
+  // repaint active handle at old and new position
+  QRect rect = activeHandleRect();
+
+  if (rect == activeHandleRect_)
+    return;
+
+  update(activeHandleRect_);
+  update(rect);
+
+  activeHandleRect_ = rect;
+}
+
+void
+CQDividedArea::
+updateHandleHover(const QPoint &p)
+{
+  int h = handleAt(p);
+
+  int id = (h >= 0 ? panes_[handles_[h].pane].widget->id() : 0);
+
+  if (id == handleHover_)
+    return;
+
+  handleHover_ = id;
+
+  if (handleHover_)
+    setCursor(Qt::SizeVerCursor);
+  else
+    unsetCursor();
+
+  updateActiveHandle();
+}
+
+void
+CQDividedArea::
+startDrag(int id)
+{
+  dragTimer_->stop();
+
+  unfreezeDrag();
+
+  dragData_ = DragData();
+
+  // ensure layout matches widgets
+  flushLayout();
+
+  if (layoutDirty_)
+    return;
+
+  int i1 = paneIndex(id); // top
+
+  if (i1 < 0 || ! layout_.pane(i1).splitter)
+    return;
+
+  int i2 = layout_.pane(i1).next; // bottom
+
+  // calc allowed drag range once from current min heights (next layout must refit
+  // from changed pane)
+  for (int i : { i1, i2 }) {
+    int minHeight = panes_[i].widget->minContentsHeight();
+
+    if (layout_.pane(i).minHeight != minHeight) {
+      layout_.pane(i).minHeight = minHeight;
+
+      layoutStart_ = std::min(layoutStart_, i);
+    }
+  }
+
+  dragData_.id    = id;
+  dragData_.range = layout_.splitterDragRange(i1);
+
+  // show snapshot of resized panes contents until drag finished
+  if (isFreezeOnDrag() && isOpaqueResize() && dragData_.range.isValid()) {
+    for (int i : { dragData_.range.pane, dragData_.range.next }) {
+      CQDividedAreaWidget *widget = panes_[i].widget;
+
+      widget->setFrozen(true);
+
+      dragData_.frozen.push_back(widget);
+    }
+  }
+}
+
+void
+CQDividedArea::
+cancelDrag()
+{
+  dragTimer_->stop();
+
+  unfreezeDrag();
+
+  if (rubberBand_)
+    rubberBand_->hide();
+
+  dragData_ = DragData();
+}
+
+void
+CQDividedArea::
+unfreezeDrag()
+{
+  for (auto &widget : dragData_.frozen) {
+    if (widget)
+      widget->setFrozen(false);
+  }
+
+  dragData_.frozen.clear();
+}
+
+void
+CQDividedArea::
+moveDrag(int d)
+{
+  if (! dragData_.range.isValid())
+    return;
+
+  dragData_.delta  += d;
+  dragData_.pending = true;
+
+  // update at most once per drag interval (accumulated delta applied on timeout)
+  if (dragInterval_ > 0 && dragData_.time.isValid()) {
+    qint64 elapsed = dragData_.time.elapsed();
+
+    if (elapsed < dragInterval_) {
+      if (! dragTimer_->isActive())
+        dragTimer_->start(int(dragInterval_ - elapsed));
+
+      return;
+    }
+  }
+
+  updateDrag();
+}
+
+void
+CQDividedArea::
+dragTimerSlot()
+{
+  if (dragData_.pending && dragData_.range.isValid())
+    updateDrag();
+}
+
+void
+CQDividedArea::
+updateDrag()
+{
+  dragTimer_->stop();
+
+  dragData_.pending = false;
+
+  dragData_.time.start();
+
+  if (isOpaqueResize())
+    applyDrag();
+  else
+    updateRubberBand();
+}
+
+void
+CQDividedArea::
+endDrag()
+{
+  dragTimer_->stop();
+
+  if (dragData_.range.isValid() && (dragData_.pending || ! isOpaqueResize()))
+    applyDrag();
+
+  unfreezeDrag();
+
+  if (rubberBand_)
+    rubberBand_->hide();
+
+  dragData_ = DragData();
+
+  updateActiveHandle();
+}
+
+void
+CQDividedArea::
+applyDrag()
+{
+  // clamp to range and update panes either side of splitter
+  const auto &range = dragData_.range;
+
+  dragData_.applied = layout_.dragSplitter(range, dragData_.delta);
+
+  panes_[range.pane].widget->resetContentsHeight(layout_.pane(range.pane).prefHeight);
+  panes_[range.next].widget->resetContentsHeight(layout_.pane(range.next).prefHeight);
+
+  for (int i = range.pane; i <= range.next; ++i)
+    applyPaneLayout(i);
+
+  // only dragged handle moved
+  auto ph = std::lower_bound(handles_.begin(), handles_.end(), range.pane,
+              [](const Handle &handle, int i) { return handle.pane < i; });
+
+  if (ph != handles_.end() && (*ph).pane == range.pane) {
+    const auto &r = layout_.pane(range.pane).splitterRect;
+
+    (*ph).rect = QRect(r.x, r.y, r.width, r.height);
+  }
+
+  updateActiveHandle();
+}
+
+void
+CQDividedArea::
+updateRubberBand()
+{
+  // show line at target splitter position (panes resized on release)
+  const auto &range = dragData_.range;
+
+  int d = std::min(std::max(dragData_.delta, range.minDelta), range.maxDelta);
+
+  const auto &rect = layout_.pane(range.pane).splitterRect;
+
+  if (! rubberBand_)
+    rubberBand_ = new QRubberBand(QRubberBand::Line, this);
+
+  rubberBand_->setGeometry(rect.x, rect.y + d, rect.width, rect.height);
+
+  if (! rubberBand_->isVisible()) {
+    rubberBand_->show();
+    rubberBand_->raise();
+  }
+}
+
+void
+CQDividedArea::
+setWidgetCollapsed(CQDividedAreaWidget *widget, bool collapsed)
+{
+  // update collapse state of widget (and others if single area) without layout
+  std::vector<CQDividedAreaWidget *> changed;
+
+  if (widget->updateCollapsed(collapsed))
+    changed.push_back(widget);
+
+  if (isSingleArea()) {
+    // collapsed so expand first other, otherwise collapse all others
+    bool expandOther = collapsed;
+
+    for (const auto &pane : panes_) {
+      CQDividedAreaWidget *widget1 = pane.widget;
+      if (widget1 == widget) continue;
+
+      if (widget1->updateCollapsed(! expandOther))
+        changed.push_back(widget1);
+
+      expandOther = false;
+    }
+  }
+
+  if (changed.empty())
+    return;
+
+  // single layout for all changes (from first changed pane)
+  int start = numPanes();
+
+  for (auto *widget1 : changed)
+    start = std::min(start, widget1->index());
+
+  invalidateLayoutFrom(start);
+
+  // expanded contents may push over memory budget
+  if (hibernatePolicy_.memoryBudget >= 0)
+    QTimer::singleShot(0, this, SLOT(hibernateSlot()));
+
+  for (auto *widget1 : changed)
+    emit widget1->collapseStateChanged(widget1->collapsed_);
+}
+
+QSize
+CQDividedArea::
+minimumSizeHint() const
+{
+  int l = contentsMargins().left  ();
+  int t = contentsMargins().top   ();
+  int r = contentsMargins().right  ();
+  int b = contentsMargins().bottom();
+
+  int w = 0;
+  int h = 0;
+
+  for (const auto &pane : panes_) {
+    QSize s = pane.widget->minimumSizeHint();
+
+    w = std::max(w, s.width());
+
+    h += s.height();
+  }
+
+  return QSize(w + l + r, h + t + b);
+}
+
+QSize
+CQDividedArea::
+sizeHint() const
+{
+  if (panes_.empty())
+    return QFrame::minimumSizeHint();
+
+  int l = contentsMargins().left  ();
+  int t = contentsMargins().top   ();
+  int r = contentsMargins().right  ();
+  int b = contentsMargins().bottom();
+
+  int w = 0;
+  int h = 0;
+
+  for (const auto &pane : panes_) {
+    QSize s = pane.widget->sizeHint();
+
+    w = std::max(w, s.width());
+
+    h += s.height();
+  }
+
+  return QSize(w + l + r, h + t + b);
 }
 
 //------
 
 CQDividedAreaWidget::
-CQDividedAreaWidget(CQDividedArea *area, int id) :
- QWidget(area), area_(area), id_(id)
+CQDividedAreaWidget(CQDividedArea *area, int id) :
+ QWidget(area), area_(area), id_(id)
+{
+  setObjectName("widget");
+
+  updateChrome();
+}
+
+void
+CQDividedAreaWidget::
+updateChrome()
+{
+  // title widget only needed if area doesn't paint titles
+  if (area_->isLightweightChrome()) {
+    delete titleWidget_;
+
+    titleWidget_ = nullptr;
+  }
+  else if (! titleWidget_) {
+    titleWidget_ = new CQDividedAreaTitle(this);
+
+    titleWidget_->setTitle(title_);
+    titleWidget_->setIcon (icon_);
+
+    titleWidget_->setVisible(true);
+  }
+
+  updateLayout();
+}
+
+void
+CQDividedAreaWidget::
+resizeEvent(QResizeEvent *)
+{
+  updateLayout();
+}
+
+void
+CQDividedAreaWidget::
+updateLayout()
+{
+  // title at top (fixed height) and contents gets the rest
+  int th = (titleWidget_ ? titleWidget_->height() : 0);
+
+  if (titleWidget_)
+    titleWidget_->setGeometry(0, 0, width(), th);
+
+  if (w_)
+    w_->setGeometry(0, th, width(), std::max(height() - th, 0));
+}
+
+void
+CQDividedAreaWidget::
+setWidget(QWidget *w)
+{
+  assert(! w_);
+
+  w_ = w;
+
+  w_->setParent(this);
+
+  w_->setVisible(! isCollapsed() && ! isFrozen());
+
+  updateLayout();
+
+  // invalidate cached sizes when contents layout changes
+  w_->installEventFilter(this);
+
+  invalidateSizeCache();
+
+  area_->contentWidgets_[w_] = this;
+}
+
+void
+CQDividedAreaWidget::
+setFactory(const CQDividedArea::WidgetFactory &factory, const QSize &sizeEstimate)
+{
+  factory_      = factory;
+  sizeEstimate_ = sizeEstimate;
+
+  invalidateSizeCache();
+}
+
+bool
+CQDividedAreaWidget::
+ensureWidget()
+{
+  if (w_)
+    return true;
+
+  if (! factory_)
+    return false;
+
+  QWidget *w = factory_();
+
+  if (! w)
+    return false;
+
+  setWidget(w);
+
+  // restore state saved on hibernate
+  if (hibernated_) {
+    const auto &policy = area_->hibernatePolicy();
+
+    if (policy.restore)
+      policy.restore(w_, hibernateState_);
+
+    hibernateState_ = QVariant();
+    hibernated_     = false;
+  }
+
+  return true;
+}
+
+void
+CQDividedAreaWidget::
+setAsync(const QFuture<QVariant> &future, const CQDividedArea::WidgetBuilder &builder,
+         const QSize &sizeEstimate)
+{
+  builder_      = builder;
+  sizeEstimate_ = sizeEstimate;
+
+  watcher_ = new QFutureWatcher<QVariant>(this);
+
+  connect(watcher_, SIGNAL(finished()), this, SLOT(asyncFinishedSlot()));
+
+  watcher_->setFuture(future);
+
+  invalidateSizeCache();
+}
+
+void
+CQDividedAreaWidget::
+asyncFinishedSlot()
+{
+  if (! watcher_)
+    return;
+
+  auto future = watcher_->future();
+
+  watcher_->deleteLater();
+
+  watcher_ = nullptr;
+
+  // build contents from result on GUI thread
+  QWidget *w = nullptr;
+
+  if (! future.isCanceled() && future.resultCount() > 0 && builder_)
+    w = builder_(future.result());
+
+  builder_ = CQDividedArea::WidgetBuilder();
+
+  if (w) {
+    setWidget(w);
+
+    updateState();
+  }
+
+  update();
+
+  // only this pane and those below change size
+  area_->invalidateLayoutFrom(index());
+}
+
+bool
+CQDividedAreaWidget::
+isLoading() const
+{
+  return (watcher_ != nullptr);
+}
+
+bool
+CQDividedAreaWidget::
+needsPrewarm() const
 {
-  setObjectName("widget");
+  if (! isCollapsed())
+    return false;
 
-  QVBoxLayout *layout = new QVBoxLayout(this);
-  layout->setMargin(0); layout->setSpacing(0);
+  // hibernated contents only recreated if hovered (not retried if factory failed)
+  if (! w_)
+    return (factory_ && ! prewarmed_ && (! hibernated_ || prewarmBump_ > 0));
 
-  titleWidget_ = new CQDividedAreaTitle(this);
-
-  layout->addWidget(titleWidget_);
+  return ! prewarmed_;
 }
 
 void
 CQDividedAreaWidget::
-setWidget(QWidget *w)
+prewarm()
 {
-  assert(! w_);
+  // create (hidden) and polish contents
+  if (ensureWidget())
+    w_->ensurePolished();
 
-  w_ = w;
+  prewarmBump_ = 0;
+  prewarmed_   = true;
+}
 
-  w_->setParent(this);
+bool
+CQDividedAreaWidget::
+hibernate()
+{
+  // can only destroy collapsed contents we can recreate
+  if (! w_ || ! factory_ || ! isCollapsed() || isFrozen())
+    return false;
+
+  const auto &policy = area_->hibernatePolicy();
+
+  hibernateState_ = (policy.save ? policy.save(w_) : QVariant());
+  hibernated_     = true;
+
+  // keep last size hint as estimate for recreated contents
+  sizeEstimate_ = contentsSizeHint();
 
-  layout()->addWidget(w_);
+  area_->contentWidgets_.erase(w_);
+
+  delete w_;
+
+  w_ = nullptr;
+
+  prewarmed_ = false;
+
+  invalidateSizeCache();
+
+  return true;
 }
 
 const QString &
 CQDividedAreaWidget::
 title() const
 {
-  return titleWidget_->title();
+  return title_;
 }
 
 void
 CQDividedAreaWidget::
 setTitle(const QString &title)
 {
-  titleWidget_->setTitle(title);
+  title_ = title;
+
+  if (titleWidget_)
+    titleWidget_->setTitle(title);
+  else
+    area_->updateChromeTitle(index_);
 }
 
 const QIcon &
 CQDividedAreaWidget::
 icon() const
 {
-  return titleWidget_->icon();
+  return icon_;
 }
 
 void
 CQDividedAreaWidget::
 setIcon(const QIcon &icon)
 {
-  titleWidget_->setIcon(icon);
+  icon_ = icon;
+
+  if (titleWidget_)
+    titleWidget_->setIcon(icon);
+  else
+    area_->updateChromeTitle(index_);
 }
 
 bool
@@ -452,14 +1907,29 @@ void
 CQDividedAreaWidget::
 setCollapsed(bool collapsed)
 {
+  area_->setWidgetCollapsed(this, collapsed);
+}
+
+bool
+CQDividedAreaWidget::
+updateCollapsed(bool collapsed)
+{
+  // layout state changed if user or temp collapsed changed (temp collapsed pane may
+  // be shown collapsed either way)
+  bool changed        = (collapsed != collapsed_ || tempCollapsed_);
+  bool visibleChanged = (collapsed != isCollapsed());
+
   collapsed_     = collapsed;
   tempCollapsed_ = false;
 
-  updateState();
+  if (visibleChanged) {
+    if (! collapsed_)
+      ++expandCount_;
 
-  area_->updateLayout();
+    updateState();
+  }
 
-  emit collapseStateChanged(collapsed_);
+  return changed;
 }
 
 void
@@ -471,20 +1941,103 @@ setTempCollapsed(bool collapsed)
   updateState();
 }
 
+void
+CQDividedAreaWidget::
+setFrozen(bool frozen)
+{
+  if (! w_ || frozen == frozen_)
+    return;
+
+  frozen_ = frozen;
+
+  if (frozen_) {
+    // replace contents with snapshot (cropped/stretched in paintEvent)
+    snapshot_ = w_->grab();
+
+    w_->setUpdatesEnabled(false);
+    w_->setVisible(false);
+  }
+  else {
+    snapshot_ = QPixmap();
+
+    w_->setUpdatesEnabled(true);
+    w_->setVisible(! isCollapsed());
+  }
+
+  update();
+}
+
+void
+CQDividedAreaWidget::
+paintEvent(QPaintEvent *)
+{
+  if (isCollapsed())
+    return;
+
+  // area paints title for lightweight chrome
+  int th = (titleWidget_ ? titleWidget_->height() : 0);
+
+  QRect rect(0, th, width(), height() - th);
+
+  // cheap placeholder while contents loading
+  if (isLoading()) {
+    QPainter painter(this);
+
+    painter.fillRect(rect, palette().window().color().darker(105));
+
+    painter.setPen(palette().color(QPalette::Disabled, QPalette::WindowText));
+
+    painter.drawText(rect, Qt::AlignCenter, "Loading...");
+
+    return;
+  }
+
+  if (! frozen_ || snapshot_.isNull())
+    return;
+
+  QPainter painter(this);
+
+  // crop snapshot if smaller, stretch if larger
+  qreal dpr = snapshot_.devicePixelRatio();
+
+  int sw = std::min(rect.width (), int(snapshot_.width ()/dpr));
+  int sh = std::min(rect.height(), int(snapshot_.height()/dpr));
+
+  painter.drawPixmap(rect, snapshot_, QRect(0, 0, int(sw*dpr), int(sh*dpr)));
+}
+
 void
 CQDividedAreaWidget::
 updateState()
 {
-  w_->setVisible(! isCollapsed());
+  // create contents on first expand
+  if (! isCollapsed())
+    ensureWidget();
+
+  if (w_)
+    w_->setVisible(! isCollapsed() && ! isFrozen());
+
+  // record collapse/expand time for hibernation
+  if (isCollapsed()) {
+    if (collapseTime_ < 0)
+      collapseTime_ = area_->clock_.elapsed();
+  }
+  else {
+    collapseTime_ = -1;
+    expandTime_   = area_->clock_.elapsed();
+  }
 
-  titleWidget_->updateState();
+  if (titleWidget_)
+    titleWidget_->updateState();
+  else
+    area_->updateChromeTitle(index_);
 }
 
 int
 CQDividedAreaWidget::
 titleHeight() const
 {
-  return titleWidget_->height();
+  return (titleWidget_ ? titleWidget_->height() : area_->chromeTitleHeight());
 }
 
 int
@@ -494,7 +2047,7 @@ contentsHeight() const
   int h = 0;
 
   if (height_ < 0)
-    h = w_->sizeHint().height();
+    h = contentsSizeHint().height();
   else
     h = height_;
 
@@ -506,6 +2059,15 @@ contentsHeight() const
 void
 CQDividedAreaWidget::
 setContentsHeight(int height)
+{
+  resetContentsHeight(height);
+
+  area_->invalidateLayoutFrom(index_);
+}
+
+void
+CQDividedAreaWidget::
+resetContentsHeight(int height)
 {
   height_ = height;
 
@@ -523,11 +2085,94 @@ int
 CQDividedAreaWidget::
 minContentsHeight() const
 {
-  QSize s = CQWidgetUtil::SmartMinSize(w_);
+  QSize s = contentsMinSize();
 
   return std::max(s.height(), Constants::MIN_HEIGHT);
 }
 
+QSize
+CQDividedAreaWidget::
+contentsSizeHint() const
+{
+  // use caller estimate until contents created (unset estimate is empty)
+  if (! w_)
+    return sizeEstimate_.expandedTo(QSize(0, 0));
+
+  if (! sizeCache_.sizeHintValid) {
+    sizeCache_.sizeHint      = w_->sizeHint();
+    sizeCache_.sizeHintValid = true;
+
+    area_->sizeCacheStats_.misses++;
+  }
+  else
+    area_->sizeCacheStats_.hits++;
+
+  return sizeCache_.sizeHint;
+}
+
+QSize
+CQDividedAreaWidget::
+contentsMinSize() const
+{
+  if (! w_)
+    return QSize(0, 0);
+
+  if (! sizeCache_.minSizeValid) {
+    sizeCache_.minSize      = CQWidgetUtil::SmartMinSize(w_);
+    sizeCache_.minSizeValid = true;
+
+    area_->sizeCacheStats_.misses++;
+  }
+  else
+    area_->sizeCacheStats_.hits++;
+
+  return sizeCache_.minSize;
+}
+
+void
+CQDividedAreaWidget::
+invalidateSizeCache()
+{
+  sizeCache_.sizeHintValid = false;
+  sizeCache_.minSizeValid  = false;
+
+  // constraints re-read at next layout
+  if (index_ >= 0)
+    area_->invalidateLayoutFrom(index_);
+}
+
+bool
+CQDividedAreaWidget::
+event(QEvent *e)
+{
+  // contents size hint or constraints changed (posted to parent by updateGeometry)
+  if (e->type() == QEvent::LayoutRequest)
+    invalidateSizeCache();
+
+  // pointer moved from area into pane (area gets no leave event for child) so clear
+  // area handle and chrome hover (and handle cursor inherited by children)
+  if (e->type() == QEvent::Enter) {
+    if (! area_->handleMouse_.pressed)
+      area_->updateHandleHover(QPoint(-1, -1));
+
+    area_->updateChromeHover(QPoint(-1, -1));
+  }
+
+  return QWidget::event(e);
+}
+
+bool
+CQDividedAreaWidget::
+eventFilter(QObject *o, QEvent *e)
+{
+  // contents internal layout changed or contents shown (constraint changes aren't
+  // posted while contents or area are hidden)
+  if (o == w_ && (e->type() == QEvent::LayoutRequest || e->type() == QEvent::Show))
+    invalidateSizeCache();
+
+  return QWidget::eventFilter(o, e);
+}
+
 QSize
 CQDividedAreaWidget::
 minimumSizeHint() const
@@ -542,8 +2187,10 @@ QSize
 CQDividedAreaWidget::
 sizeHint() const
 {
-  int w = w_->sizeHint().width();
-  int h = w_->sizeHint().height();
+  QSize s = contentsSizeHint();
+
+  int w = s.width();
+  int h = s.height();
 
   h += titleHeight();
 
@@ -604,6 +2251,8 @@ CQDividedAreaTitle::
 setIconSize(const QSize &s)
 {
   iconSize_ = s;
+
+  update();
 }
 
 void
@@ -634,46 +2283,174 @@ paintEvent(QPaintEvent *)
 {
   QPainter painter(this);
 
-  bg_ = widget_->palette().window().color().darker(110);
+  // redraw cached chrome only if anything it depends on changed
+  RenderKey key;
 
-  painter.fillRect(rect(), QBrush(bg_));
+  key.size       = size();
+  key.dpr        = devicePixelRatioF();
+  key.title      = title_;
+  key.iconKey    = icon_.cacheKey();
+  key.iconSize   = iconSize_;
+  key.paletteKey = widget_->palette().cacheKey();
+  key.fontKey    = font().key();
+  key.collapsed  = widget_->isCollapsed();
 
-  int x = 2;
-  int h = height();
+  if (! pixmap_.isNull() && key == renderKey_) {
+    painter.drawPixmap(0, 0, pixmap_);
+    return;
+  }
+
+  CQDividedArea *area = widget_->area();
+
+  bool threaded = (area->isThreadedTitles() && area->isThreadedTitlesSupported());
+
+  RenderData data = renderData(key, threaded);
+
+  if (! threaded) {
+    renderKey_ = key;
+    pixmap_    = QPixmap::fromImage(renderImage(data));
+
+    painter.drawPixmap(0, 0, pixmap_);
+
+    return;
+  }
+
+  // render in thread pool (one job at a time, restarted on finish if out of date)
+  if (! renderWatcher_) {
+    renderWatcher_ = new QFutureWatcher<QImage>(this);
+
+    connect(renderWatcher_, SIGNAL(finished()), this, SLOT(renderFinishedSlot()));
+
+    pendingKey_ = key;
+
+    renderWatcher_->setFuture(QtConcurrent::run(&CQDividedAreaTitle::renderImage, data));
+  }
+
+  // show out of date image if same size otherwise flat fallback
+  if (! pixmap_.isNull() && renderKey_.size == key.size && renderKey_.dpr == key.dpr) {
+    painter.drawPixmap(0, 0, pixmap_);
+    return;
+  }
+
+  painter.fillRect(rect(), QBrush(data.bg));
+
+  painter.setPen(data.line);
+
+  painter.drawLine(0, height() - 1, width() - 1, height() - 1);
+}
+
+void
+CQDividedAreaTitle::
+renderFinishedSlot()
+{
+  auto future = renderWatcher_->future();
+
+  renderWatcher_->deleteLater();
+
+  renderWatcher_ = nullptr;
+
+  if (future.resultCount() > 0) {
+    renderKey_ = pendingKey_;
+    pixmap_    = QPixmap::fromImage(future.result());
+  }
+
+  // repaint (restarts render if state changed since job started)
+  update();
+}
 
+CQDividedAreaTitle::RenderData
+CQDividedAreaTitle::
+renderData(const RenderKey &key, bool threaded) const
+{
+  // capture everything needed by value so render can run off GUI thread
+  RenderData data;
+
+  data.size        = key.size;
+  data.dpr         = key.dpr;
+  data.font        = font();
+  data.iconSize    = iconSize();
+  data.bg          = widget_->palette().window().color().darker(110);
+  data.fg          = palette().color(QPalette::WindowText);
+  data.line        = widget_->palette().window().color().darker(200);
+  data.buttonWidth = collapseButton_->width();
+
+  // icon engines aren't thread safe so rasterize here
   int iw = 0;
 
   if (! icon_.isNull()) {
+    data.icon = icon_.pixmap(iconSize()).toImage();
+
     iw = iconSize().width() + 2;
+  }
 
-    painter.drawPixmap(x, (h - iconSize().height())/2, icon().pixmap(iconSize()));
+  // elide in render if threaded, otherwise use shared cache
+  if (title_.length()) {
+    data.textWidth = key.size.width() - iw - data.buttonWidth - 6;
 
-    x += iw;
+    if (threaded)
+      data.title = title_;
+    else
+      data.staticText = widget_->area()->elidedTitle(title_, data.font, data.textWidth);
   }
 
-  int bw = collapseButton_->width();
+  return data;
+}
+
+QImage
+CQDividedAreaTitle::
+renderImage(const RenderData &data)
+{
+  QImage image(QSize(int(data.size.width()*data.dpr), int(data.size.height()*data.dpr)),
+               QImage::Format_ARGB32_Premultiplied);
 
-  if (title_.length()) {
-    QFontMetrics fm(font());
+  image.setDevicePixelRatio(data.dpr);
 
-    QString title = fm.elidedText(title_, Qt::ElideRight, width() - iw - bw - 6);
+  QPainter painter(&image);
 
-    // if just an ellipsis keep first letter
-    if (title.length() == 0 || title.utf16()[0] == 8230)
-      title = title_[0] + "..";
+  int w = data.size.width ();
+  int h = data.size.height();
 
-    painter.drawText(x, (h - fm.height())/2 + fm.ascent(), title);
+  painter.fillRect(QRect(0, 0, w, h), QBrush(data.bg));
+
+  int x = 2;
+
+  int iw = 0;
+
+  if (! data.icon.isNull()) {
+    iw = data.iconSize.width() + 2;
+
+    painter.drawImage(QRect(QPoint(x, (h - data.iconSize.height())/2), data.iconSize), data.icon);
+
+    x += iw;
   }
 
-  QRect buttonRect(collapseButton_->x() - 2, 0, bw + 4, height());
+  if (data.title.length() || ! data.staticText.text().isEmpty()) {
+    painter.setFont(data.font);
+    painter.setPen (data.fg);
 
-  painter.fillRect(buttonRect, QBrush(bg_));
+    QFontMetrics fm(data.font);
 
-  QColor c = widget_->palette().window().color().darker(200);
+    int y = (h - fm.height())/2;
 
-  painter.setPen(c);
+    if (data.title.length())
+      painter.drawText(x, y + fm.ascent(), elideTitle(data.title, data.font, data.textWidth));
+    else
+      painter.drawStaticText(x, y, data.staticText);
+  }
 
-  painter.drawLine(0, height() - 1, width() - 1, height() - 1);
+  painter.setPen(data.line);
+
+  painter.drawLine(0, h - 1, w - 1, h - 1);
+
+  return image;
+}
+
+void
+CQDividedAreaTitle::
+enterEvent(QEvent *)
+{
+  // likely to be expanded soon
+  widget_->area()->prewarmWidget(widget_);
 }
 
 void
@@ -749,97 +2526,3 @@ paintEvent(QPaintEvent *)
 
   p.drawComplexControl(QStyle::CC_ToolButton, opt);
 }
-
-//------
-
-CQDividedAreaSplitter::
-CQDividedAreaSplitter(CQDividedArea *area, int id) :
- QWidget(area), area_(area), id_(id)
-{
-  setObjectName("splitter");
-
-  setFixedHeight(5);
-
-  setCursor(Qt::SizeVerCursor);
-
-  setMouseTracking(true);
-}
-
-void
-CQDividedAreaSplitter::
-paintEvent(QPaintEvent *)
-{
-  QStylePainter ps(this);
-
-  QStyleOption opt;
-
-  opt.initFrom(this);
-
-  opt.rect  = rect();
-//opt.state = (orient_ == Qt::Horizontal ? QStyle::State_None : QStyle::State_Horizontal);
-  opt.state = QStyle::State_None;
-
-  if (mouseState_.pressed)
-    opt.state |= QStyle::State_Sunken;
-
-  if (mouseOver_)
-    opt.state |= QStyle::State_MouseOver;
-
-  ps.drawControl(QStyle::CE_Splitter, opt);
-}
-
-void
-CQDividedAreaSplitter::
-mousePressEvent(QMouseEvent *e)
-{
-  mouseState_.pressed  = true;
-  mouseState_.pressPos = e->globalPos();
-
-  update();
-}
-
-void
-CQDividedAreaSplitter::
-mouseMoveEvent(QMouseEvent *e)
-{
-  if (! mouseState_.pressed) return;
-
-  int dy = e->globalPos().y() - mouseState_.pressPos.y();
-
-  if (dy) {
-    //move(pos().x(), pos().y() + dy);
-
-    emit moved(dy);
-
-    mouseState_.pressPos = e->globalPos();
-  }
-
-  update();
-}
-
-void
-CQDividedAreaSplitter::
-mouseReleaseEvent(QMouseEvent *)
-{
-  mouseState_.pressed = false;
-
-  update();
-}
-
-void
-CQDividedAreaSplitter::
-enterEvent(QEvent *)
-{
-  mouseOver_ = true;
-
-  update();
-}
-
-void
-CQDividedAreaSplitter::
-leaveEvent(QEvent *)
-{
-  mouseOver_ = false;
-
-  update();
-}
@@ -6,16 +6,18 @@ TARGET = CQDividedArea
 
 DEPENDPATH += .
 
-QT += widgets
+QT += widgets concurrent
 
 CONFIG += staticlib
 
 # Input
 HEADERS += \
 ../include/CQDividedArea.h \
+../include/CQDividedAreaLayout.h \
 
 SOURCES += \
 CQDividedArea.cpp \
+CQDividedAreaLayout.cpp \
 
 OBJECTS_DIR = ../obj
 
@@ -0,0 +1,469 @@
+#include <CQDividedAreaLayout.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cassert>
+
+CQDividedAreaLayout::
+CQDividedAreaLayout()
+{
+}
+
+void
+CQDividedAreaLayout::
+setSplitterHeight(int h)
+{
+  if (h == splitterHeight_)
+    return;
+
+  splitterHeight_ = h;
+
+  dirtyStart_ = 0;
+}
+
+void
+CQDividedAreaLayout::
+setNumPanes(int n)
+{
+  dirtyStart_ = std::min(dirtyStart_, std::min(n, numPanes()));
+
+  panes_.resize(std::size_t(n));
+}
+
+int
+CQDividedAreaLayout::
+addPane(const Pane &pane)
+{
+  dirtyStart_ = std::min(dirtyStart_, numPanes());
+
+  panes_.push_back(pane);
+
+  return numPanes() - 1;
+}
+
+void
+CQDividedAreaLayout::
+removePane(int i)
+{
+  assert(i >= 0 && i < numPanes());
+
+  dirtyStart_ = std::min(dirtyStart_, i);
+
+  panes_.erase(panes_.begin() + i);
+}
+
+void
+CQDividedAreaLayout::
+clear()
+{
+  panes_.clear();
+
+  lastExpanded_ = -1;
+  dirtyStart_   = 0;
+}
+
+void
+CQDividedAreaLayout::
+solve(const Rect &rect, int start)
+{
+  // all panes move if rect changed
+  if (rect != rect_)
+    start = 0;
+
+  // include panes changed by add/remove/drag
+  start = std::max(std::min(start, dirtyStart_), 0);
+
+  rect_ = rect;
+
+  start = std::min(start, solveFit(start));
+
+  place(start);
+
+  dirtyStart_ = std::numeric_limits<int>::max();
+}
+
+CQDividedAreaLayout::DragRange
+CQDividedAreaLayout::
+splitterDragRange(int i) const
+{
+  DragRange range;
+
+  if (i < 0 || i >= numPanes())
+    return range;
+
+  const Pane &pane1 = panes_[i];
+
+  if (! pane1.splitter)
+    return range;
+
+  const Pane &pane2 = panes_[pane1.next];
+
+  range.pane    = i;
+  range.next    = pane1.next;
+  range.height1 = pane1.contentsHeight();
+  range.height2 = pane2.contentsHeight();
+
+  // allow drag back to current position even if below min height
+  range.minDelta = std::min(pane1.minHeight - range.height1, 0);
+  range.maxDelta = std::max(range.height2 - pane2.minHeight, 0);
+
+  return range;
+}
+
+int
+CQDividedAreaLayout::
+dragSplitter(const DragRange &range, int d)
+{
+  assert(range.isValid());
+
+  d = std::min(std::max(d, range.minDelta), range.maxDelta);
+
+  // preferred heights changed
+  dirtyStart_ = std::min(dirtyStart_, range.pane);
+
+  Pane &pane1 = panes_[range.pane];
+  Pane &pane2 = panes_[range.next];
+
+  int h1 = range.height1 + d;
+  int h2 = range.height2 - d;
+
+  pane1.prefHeight  = h1; pane1.adjust = 0;
+  pane1.rect.height = pane1.titleHeight + h1;
+
+  // move collapsed panes between, splitter and bottom pane (bottom unchanged)
+  int y = pane1.rect.bottom();
+
+  for (int i = range.pane + 1; i < range.next; ++i) {
+    Pane &pane = panes_[i];
+
+    pane.rect.y = y;
+
+    y += pane.rect.height;
+  }
+
+  pane1.splitterRect.y = y;
+
+  y += pane1.splitterRect.height;
+
+  pane2.prefHeight  = h2; pane2.adjust = 0;
+  pane2.rect.y      = y;
+  pane2.rect.height = pane2.titleHeight + h2;
+
+  return d;
+}
+
+int
+CQDividedAreaLayout::
+firstChanged() const
+{
+  int n = numPanes();
+
+  for (int i = 0; i < n; ++i) {
+    const Pane &pane = panes_[i];
+
+    if (pane.tempCollapsed != old_[i].first || pane.adjust != old_[i].second)
+      return i;
+  }
+
+  return n;
+}
+
+CQDividedAreaLayout::FitSums
+CQDividedAreaLayout::
+addFitSums(const FitSums &sums, const Pane &pane)
+{
+  FitSums sums1 = sums;
+
+  sums1.title += pane.titleHeight;
+
+  if (! pane.collapsed) {
+    sums1.min   += pane.minHeight;
+    sums1.delta += std::max(pane.prefHeight - pane.minHeight, 0);
+
+    ++sums1.visible;
+  }
+
+  return sums1;
+}
+
+// Calculate temp collapsed panes and contents adjust for panes which must fit in rect.
+//
+// The last expanded pane fills the remaining space. If the panes don't fit then all
+// other expanded panes are shrunk by the same amount (down to their minimum height)
+// and if they still don't fit the last expanded pane is temp collapsed and we retry.
+//
+// If the last fit had no temp collapsed or shrunk panes the sums of the panes above start
+// are reused and if the panes still fit nothing above start changes.
+//
+// Returns first pane whose temp collapsed or adjust changed.
+int
+CQDividedAreaLayout::
+solveFit(int start)
+{
+  int n  = numPanes();
+  int h  = rect_.height;
+  int sh = splitterHeight_;
+
+  start = std::min(start, n);
+
+  if (fitClean_ && int(prefix_.size()) > start) {
+    prefix_.resize(std::size_t(n + 1));
+
+    for (int i = start; i < n; ++i)
+      prefix_[i + 1] = addFitSums(prefix_[i], panes_[i]);
+
+    int last = n - 1;
+
+    while (last >= 0 && panes_[last].collapsed)
+      --last;
+
+    bool fits = true;
+
+    if (last >= 0) {
+      const FitSums &sums = prefix_[n];
+
+      int extra = h - sums.title - (sums.visible - 1)*sh - sums.min;
+
+      fits = (extra >= 0 && prefix_[last].delta <= extra);
+    }
+
+    if (fits) {
+      for (int i = start; i < n; ++i) {
+        panes_[i].tempCollapsed = false;
+        panes_[i].adjust        = 0;
+      }
+
+      return n;
+    }
+  }
+
+  //---
+
+  // previous solution to find first change
+  old_.clear();
+
+  old_.reserve(std::size_t(n));
+
+  prefix_.resize(std::size_t(n + 1));
+
+  int sumTitle = 0, sumPref = 0, sumMin = 0, numVisible = 0;
+
+  for (int i = 0; i < n; ++i) {
+    Pane &pane = panes_[i];
+
+    old_.emplace_back(pane.tempCollapsed, pane.adjust);
+
+    pane.tempCollapsed = false;
+    pane.adjust        = 0;
+
+    prefix_[i + 1] = addFitSums(prefix_[i], pane);
+
+    sumTitle += pane.titleHeight;
+
+    if (pane.collapsed) continue;
+
+    sumPref += pane.prefHeight;
+    sumMin  += pane.minHeight;
+
+    ++numVisible;
+  }
+
+  fitClean_ = false;
+
+  int numExpanded = numVisible;
+
+  // temp collapse last expanded until remaining panes fit at their min heights
+  int last  = n - 1;
+  int extra = 0;
+
+  for ( ; last >= 0; --last) {
+    Pane &pane = panes_[last];
+
+    if (pane.collapsed) continue;
+
+    extra = h - sumTitle - (numVisible - 1)*sh - sumMin;
+
+    if (extra >= 0)
+      break;
+
+    pane.tempCollapsed = true;
+
+    sumPref -= pane.prefHeight;
+    sumMin  -= pane.minHeight;
+
+    --numVisible;
+  }
+
+  if (last < 0) {
+    fitClean_ = (numExpanded == 0);
+
+    return firstChanged();
+  }
+
+  bool anyTempCollapsed = (numVisible < numExpanded);
+
+  // extra is space available above min heights for non-last panes, if
+  // preferred heights exceed this find smallest common shrink which fits
+  deltas_.clear();
+
+  int sumDelta = 0;
+  int maxDelta = 0;
+
+  for (int i = 0; i < last; ++i) {
+    const Pane &pane = panes_[i];
+
+    if (! pane.isExpanded()) continue;
+
+    int d = pane.prefHeight - pane.minHeight;
+
+    if (d <= 0) continue;
+
+    deltas_.push_back(d);
+
+    sumDelta += d;
+    maxDelta  = std::max(maxDelta, d);
+  }
+
+  if (sumDelta <= extra && ! anyTempCollapsed) {
+    fitClean_ = true;
+
+    return firstChanged();
+  }
+
+  // panes are only temp collapsed when all others are at their min height
+  // so keep them there
+  if (anyTempCollapsed) {
+    for (int i = 0; i < last; ++i) {
+      Pane &pane = panes_[i];
+
+      if (pane.isExpanded())
+        pane.adjust = maxDelta;
+    }
+
+    return firstChanged();
+  }
+
+  std::sort(deltas_.begin(), deltas_.end(), std::greater<int>());
+
+  int numDeltas = int(deltas_.size());
+
+  int adjust = 0;
+  int sum    = 0;
+
+  for (int k = 1; k <= numDeltas; ++k) {
+    sum += deltas_[k - 1];
+
+    int next = (k < numDeltas ? deltas_[k] : 0);
+
+    adjust = (sum - extra + k - 1)/k;
+
+    if (adjust >= next)
+      break;
+  }
+
+  for (int i = 0; i < last; ++i) {
+    Pane &pane = panes_[i];
+
+    if (pane.isExpanded())
+      pane.adjust = adjust;
+  }
+
+  return firstChanged();
+}
+
+// Place panes (and splitters between expanded panes) in rect in a single pass.
+//
+// Pane y values are the prefix sums of the pane (and splitter) heights above so if only
+// panes from start changed we can continue from the expanded pane above start (whose
+// splitter may change). The last expanded pane (old and new) fills the remaining space
+// so is always placed.
+void
+CQDividedAreaLayout::
+place(int start)
+{
+  int n  = numPanes();
+  int x  = rect_.x;
+  int w  = rect_.width;
+  int sh = splitterHeight_;
+
+  // find last expanded and size of collapsed titles below it
+  int last      = -1;
+  int lastSpace = 0;
+
+  for (int i = n - 1; i >= 0; --i) {
+    if (panes_[i].isExpanded()) {
+      last = i;
+      break;
+    }
+
+    lastSpace += panes_[i].titleHeight;
+  }
+
+  int bottom = rect_.bottom();
+
+  //---
+
+  // find first pane to place
+  int i1 = std::min(start, n);
+
+  if (last          >= 0) i1 = std::min(i1, last);
+  if (lastExpanded_ >= 0) i1 = std::min(i1, lastExpanded_);
+
+  int prev = i1 - 1;
+
+  while (prev >= 0 && ! panes_[prev].isExpanded())
+    --prev;
+
+  int y = rect_.y;
+
+  if      (prev >= 0) {
+    i1 = prev;
+    y  = panes_[i1].rect.y;
+  }
+  else if (i1 > 0)
+    y = panes_[i1 - 1].rect.bottom(); // only collapsed (no splitters) above
+
+  placeStart_   = i1;
+  lastExpanded_ = last;
+
+  //---
+
+  int lastExpanded = -1;
+
+  for (int i = i1; i < n; ++i) {
+    Pane &pane = panes_[i];
+
+    pane.splitter = false;
+    pane.next     = -1;
+
+    bool expanded = pane.isExpanded();
+
+    if (expanded && lastExpanded >= 0) {
+      Pane &lastPane = panes_[lastExpanded];
+
+      lastPane.splitter     = true;
+      lastPane.splitterRect = Rect(x, y, w, sh);
+      lastPane.next         = i;
+
+      y += sh;
+    }
+
+    int wh = pane.titleHeight;
+
+    if (expanded) {
+      if (i == last)
+        wh = bottom - y - lastSpace;
+      else
+        wh += pane.prefHeight - pane.adjust;
+
+      wh = std::max(wh, pane.titleHeight + pane.minHeight);
+
+      lastExpanded = i;
+    }
+
+    pane.rect = Rect(x, y, w, wh);
+
+    y += wh;
+  }
+}